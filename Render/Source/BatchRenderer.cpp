@@ -0,0 +1,169 @@
+/*
+  ==============================================================================
+
+    Batch rendering of many files across all cores.
+
+  ==============================================================================
+*/
+
+#include "BatchRenderer.h"
+#include <map>
+#include <numeric>
+
+//==============================================================================
+BatchRenderer::BatchRenderer(int threads, int blockSize, SimdKernel kernel)
+	: m_threads(threads > 0 ? threads : juce::SystemStats::getNumCpus()), m_blockSize(blockSize), m_kernel(kernel)
+{
+}
+
+std::vector<BatchRenderer::FileResult> BatchRenderer::run(const juce::Array<juce::File>& inputs, const juce::File& outputFolder, const ParameterSnapshot& parameters)
+{
+	m_inputs.assign(inputs.begin(), inputs.end());
+	m_results.assign(m_inputs.size(), FileResult());
+	m_outputs.clear();
+	m_parameters = parameters;
+	m_next = 0;
+
+	// Inputs differing only in their extension, a.wav and a.flac, would write the same a.wav. The first in
+	// input order keeps it, the others fail instead of overwriting it from another thread.
+	std::map<juce::String, size_t> outputOwners;
+
+	for (size_t index = 0; index < m_inputs.size(); ++index)
+	{
+		const auto& input = m_inputs[index];
+		const auto output = outputFolder.getChildFile(input.getFileNameWithoutExtension()).withFileExtension("wav");
+		const auto path = juce::File::areFileNamesCaseSensitive() ? output.getFullPathName() : output.getFullPathName().toLowerCase();
+		const auto owner = outputOwners.emplace(path, index).first->second;
+
+		m_outputs.push_back(output);
+		m_results[index].input = input;
+
+		if (owner != index)
+			m_results[index].error = "Same output file as " + m_inputs[owner].getFileName() + ", not rendered";
+	}
+
+	// Long files first, so the last ones to start are short and the workers finish together
+	std::vector<juce::int64> sizes;
+	for (const auto& input : m_inputs)
+		sizes.push_back(input.getSize());
+
+	m_order.resize(m_inputs.size());
+	std::iota(m_order.begin(), m_order.end(), 0);
+	std::stable_sort(m_order.begin(), m_order.end(), [&sizes](int a, int b) { return sizes[(size_t)a] > sizes[(size_t)b]; });
+
+	const int threads = juce::jmax(1, juce::jmin(m_threads, (int)m_inputs.size()));
+	std::vector<std::unique_ptr<Worker>> workers;
+
+	for (int thread = 0; thread < threads; ++thread)
+		workers.push_back(std::make_unique<Worker>(*this, m_blockSize, m_kernel));
+
+	const auto start = juce::Time::getHighResolutionTicks();
+
+	for (auto& worker : workers)
+		worker->startThread();
+
+	for (auto& worker : workers)
+		worker->waitForThreadToExit(-1);
+
+	m_wallSeconds = juce::Time::highResolutionTicksToSeconds(juce::Time::getHighResolutionTicks() - start);
+
+	return m_results;
+}
+
+//==============================================================================
+BatchRenderer::Worker::Worker(BatchRenderer& owner, int blockSize, SimdKernel kernel)
+	: juce::Thread("Batch render"), m_owner(owner), m_renderer(blockSize)
+{
+	m_renderer.setKernel(kernel);
+}
+
+void BatchRenderer::Worker::run()
+{
+	const int count = (int)m_owner.m_order.size();
+
+	for (int next = m_owner.m_next++; next < count && !threadShouldExit(); next = m_owner.m_next++)
+	{
+		const int index = m_owner.m_order[(size_t)next];
+		auto& result = m_owner.m_results[(size_t)index];
+
+		if (result.error.isNotEmpty())
+			continue;
+
+		const auto start = juce::Time::getHighResolutionTicks();
+
+		result.error = m_renderer.render(result.input, m_owner.m_outputs[(size_t)index], m_owner.m_parameters);
+		result.seconds = juce::Time::highResolutionTicksToSeconds(juce::Time::getHighResolutionTicks() - start);
+		result.processingSeconds = m_renderer.getProcessingSeconds();
+		result.samples = m_renderer.getProcessedSamples();
+		result.audioSeconds = m_renderer.getProcessedSeconds();
+	}
+}
+
+//==============================================================================
+BatchRenderer::Summary BatchRenderer::summarize(const std::vector<FileResult>& results) const
+{
+	Summary summary;
+	summary.threads = juce::jmax(1, juce::jmin(m_threads, (int)results.size()));
+	summary.files = (int)results.size();
+	summary.wallSeconds = m_wallSeconds;
+
+	std::vector<double> latencies;
+
+	for (const auto& result : results)
+	{
+		if (result.error.isNotEmpty())
+		{
+			++summary.failed;
+			continue;
+		}
+
+		summary.samples += result.samples;
+		summary.audioSeconds += result.audioSeconds;
+		latencies.push_back(result.seconds);
+	}
+
+	if (!latencies.empty())
+	{
+		std::sort(latencies.begin(), latencies.end());
+
+		auto percentile = [&latencies](double fraction)
+		{
+			return latencies[(size_t)juce::roundToInt(fraction * (double)(latencies.size() - 1))];
+		};
+
+		summary.minSeconds = latencies.front();
+		summary.medianSeconds = percentile(0.5);
+		summary.p95Seconds = percentile(0.95);
+		summary.maxSeconds = latencies.back();
+	}
+
+	return summary;
+}
+
+void BatchRenderer::print(const FileResult& result)
+{
+	if (result.error.isNotEmpty())
+	{
+		std::cout << result.input.getFileName() << ": " << result.error << std::endl;
+		return;
+	}
+
+	std::cout << result.input.getFileName() << ": "
+	          << juce::String(result.seconds * 1000.0, 1) << " ms, engine "
+	          << juce::String(result.processingSeconds * 1000.0, 1) << " ms, "
+	          << juce::String(result.audioSeconds / juce::jmax(1.0e-9, result.seconds), 1) << "x realtime" << std::endl;
+}
+
+void BatchRenderer::print(const Summary& summary)
+{
+	const double wallSeconds = juce::jmax(1.0e-9, summary.wallSeconds);
+
+	std::cout << summary.files - summary.failed << " of " << summary.files << " files on " << summary.threads << " threads in "
+	          << juce::String(summary.wallSeconds, 2) << " s" << std::endl;
+	std::cout << "throughput: " << juce::String((double)summary.samples / wallSeconds / 1.0e6, 2) << " Msamples/s, "
+	          << juce::String(summary.audioSeconds / wallSeconds, 1) << "x realtime" << std::endl;
+	std::cout << "per file ms: min " << juce::String(summary.minSeconds * 1000.0, 1)
+	          << ", median " << juce::String(summary.medianSeconds * 1000.0, 1)
+	          << ", p95 " << juce::String(summary.p95Seconds * 1000.0, 1)
+	          << ", max " << juce::String(summary.maxSeconds * 1000.0, 1) << std::endl;
+}
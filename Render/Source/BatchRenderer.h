@@ -0,0 +1,85 @@
+/*
+  ==============================================================================
+
+    Batch rendering of many files across all cores.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "OfflineRenderer.h"
+
+//==============================================================================
+// Renders a list of files on a pool of worker threads, each with its own OfflineRenderer and
+// so its own engine and block buffer. Files are handed out largest first from one shared
+// cursor, so a worker that finishes early takes the next file instead of waiting on others.
+class BatchRenderer
+{
+public:
+	struct FileResult
+	{
+		juce::File input;
+		juce::String error;
+		juce::int64 samples = 0;
+		double audioSeconds = 0.0;
+		double seconds = 0.0;           // open to close, reading and writing included
+		double processingSeconds = 0.0; // engine alone
+	};
+
+	struct Summary
+	{
+		int threads = 0;
+		int files = 0;
+		int failed = 0;
+		double wallSeconds = 0.0;
+		double audioSeconds = 0.0;
+		juce::int64 samples = 0;
+
+		// Per file latencies, open to close
+		double minSeconds = 0.0;
+		double medianSeconds = 0.0;
+		double p95Seconds = 0.0;
+		double maxSeconds = 0.0;
+	};
+
+	// threads 0 uses one per logical CPU
+	BatchRenderer(int threads, int blockSize, SimdKernel kernel = SimdKernel::Auto);
+
+	// Renders every input to a WAV file of the same name in outputFolder. Results are in input order.
+	// Inputs whose output another input already has fail without rendering, as do outputs that
+	// would replace their input.
+	std::vector<FileResult> run(const juce::Array<juce::File>& inputs, const juce::File& outputFolder, const ParameterSnapshot& parameters);
+
+	Summary summarize(const std::vector<FileResult>& results) const;
+
+	static void print(const FileResult& result);
+	static void print(const Summary& summary);
+
+private:
+	class Worker : public juce::Thread
+	{
+	public:
+		Worker(BatchRenderer& owner, int blockSize, SimdKernel kernel);
+
+		void run() override;
+
+	private:
+		BatchRenderer& m_owner;
+		OfflineRenderer m_renderer;
+	};
+
+	int m_threads;
+	int m_blockSize;
+	SimdKernel m_kernel;
+	double m_wallSeconds = 0.0;
+
+	// Shared with the workers while run is active
+	std::vector<juce::File> m_inputs;
+	std::vector<int> m_order; // indices into m_inputs, largest file first
+	std::vector<FileResult> m_results;
+	std::vector<juce::File> m_outputs; // per input
+	ParameterSnapshot m_parameters;
+	std::atomic<int> m_next{ 0 };
+};
@@ -0,0 +1,436 @@
+/*
+  ==============================================================================
+
+    Throughput benchmark for MultibandMSAudioProcessor::processBlock.
+
+  ==============================================================================
+*/
+
+#include "Benchmark.h"
+#include "OfflineRenderer.h"
+#include "../../Source/CrossoverTree.h"
+
+//==============================================================================
+Benchmark::Benchmark(double seconds, int repeats) : m_seconds(seconds), m_repeats(juce::jmax(1, repeats))
+{
+}
+
+Benchmark::Signal Benchmark::parseSignal(const juce::String& name)
+{
+	if (name.equalsIgnoreCase("sine"))
+		return Signal::Sine;
+
+	if (name.equalsIgnoreCase("tail"))
+		return Signal::Tail;
+
+	if (name.equalsIgnoreCase("glide"))
+		return Signal::Glide;
+
+	return Signal::Noise;
+}
+
+Benchmark::Precision Benchmark::parsePrecision(const juce::String& name)
+{
+	if (name.equalsIgnoreCase("double"))
+		return Precision::Double;
+
+	return Precision::Single;
+}
+
+void Benchmark::generate(juce::AudioBuffer<float>& buffer, double sampleRate, Signal signal)
+{
+	const int samples = buffer.getNumSamples();
+	auto* left = buffer.getWritePointer(0);
+	auto* right = buffer.getWritePointer(1);
+
+	if (signal == Signal::Sine)
+	{
+		// Slightly detuned channels so the side signal is not zero
+		const double pi = juce::MathConstants<double>::pi;
+		const double deltaLeft = 2.0 * pi * 440.0 / sampleRate;
+		const double deltaRight = 2.0 * pi * 443.0 / sampleRate;
+
+		for (int sample = 0; sample < samples; ++sample)
+		{
+			left[sample] = 0.5f * (float)std::sin(deltaLeft * sample);
+			right[sample] = 0.5f * (float)std::sin(deltaRight * sample);
+		}
+	}
+	else if (signal == Signal::Tail)
+	{
+		// Noise fading out by 120 dB over 100 ms at the start of every second, then digital
+		// silence, the fade out case in which recursive filter states end up subnormal
+		juce::Random random(0x5a22);
+		const int period = juce::jmax(1, (int)sampleRate);
+		const int fadeSamples = juce::jmax(1, (int)(0.1 * sampleRate));
+		const double decay = std::log(1.0e-6) / fadeSamples;
+
+		for (int sample = 0; sample < samples; ++sample)
+		{
+			const int position = sample % period;
+			const float gain = position < fadeSamples ? 0.5f * (float)std::exp(decay * position) : 0.0f;
+
+			left[sample] = gain * (random.nextFloat() - 0.5f);
+			right[sample] = gain * (random.nextFloat() - 0.5f);
+		}
+	}
+	else
+	{
+		juce::Random random(0x5a22);
+
+		for (int sample = 0; sample < samples; ++sample)
+		{
+			left[sample] = random.nextFloat() - 0.5f;
+			right[sample] = random.nextFloat() - 0.5f;
+		}
+	}
+}
+
+void Benchmark::glide(float* frequencies, int position, double sampleRate)
+{
+	// One sweep down and up every two seconds, both crossovers over their whole parameter range
+	const double phase = 0.5 + 0.5 * std::cos(juce::MathConstants<double>::pi * position / sampleRate);
+
+	frequencies[0] = (float)(80.0 * std::pow(880.0 / 80.0, phase));
+	frequencies[1] = (float)(1760.0 * std::pow(7040.0 / 1760.0, phase));
+}
+
+Benchmark::Result Benchmark::run(double sampleRate, int blockSize, Signal signal, Precision precision, const juce::ArgumentList& args)
+{
+	if (precision == Precision::Double)
+		return run<double>(sampleRate, blockSize, signal, args);
+
+	return run<float>(sampleRate, blockSize, signal, args);
+}
+
+template <typename SampleType>
+Benchmark::Result Benchmark::run(double sampleRate, int blockSize, Signal signal, const juce::ArgumentList& args)
+{
+	const int samples = (int)(m_seconds * sampleRate);
+
+	// --engine times MultibandEngine::process on its own, without the plugin around it
+	const bool engineOnly = args.containsOption("--engine");
+	const bool gliding = signal == Signal::Glide;
+	ParameterSnapshot parameters = OfflineRenderer::readSnapshot(args);
+	const SimdKernel kernel = OfflineRenderer::readKernel(args);
+
+	if (gliding)
+	{
+		parameters.linearPhase = true;
+		parameters.update();
+	}
+
+	MultibandMSAudioProcessor processor;
+	MultibandEngine engine;
+	engine.setKernel(kernel);
+	processor.setKernel(kernel);
+
+	if (engineOnly)
+	{
+		OfflineRenderer::prepare(engine, sampleRate, blockSize, parameters);
+	}
+	else
+	{
+		processor.setProcessingPrecision(std::is_same<SampleType, double>::value ? juce::AudioProcessor::doublePrecision
+		                                                                         : juce::AudioProcessor::singlePrecision);
+		OfflineRenderer::prepare(processor, sampleRate, blockSize);
+		OfflineRenderer::applyParameters(processor, args);
+
+		if (gliding)
+			processor.apvts.getParameter(MultibandMSAudioProcessor::paramsNames[7])->setValueNotifyingHost(1.0f);
+	}
+
+	auto* frequencyLowMid = processor.apvts.getParameter(MultibandMSAudioProcessor::paramsNames[1]);
+	auto* frequencyMidHigh = processor.apvts.getParameter(MultibandMSAudioProcessor::paramsNames[3]);
+
+	juce::AudioBuffer<float> signalBuffer(2, samples);
+	juce::AudioBuffer<SampleType> buffer(2, samples);
+	generate(signalBuffer, sampleRate, signal);
+
+	juce::MidiBuffer midi;
+	double bestSeconds = std::numeric_limits<double>::max();
+	double bestMaxBlockSeconds = 0.0;
+
+	for (int repeat = 0; repeat < m_repeats; ++repeat)
+	{
+		buffer.makeCopyOf(signalBuffer);
+
+		// Blocks are timed one by one, the glide's parameter changes in between are not counted
+		double seconds = 0.0;
+		double maxBlockSeconds = 0.0;
+
+		for (int position = 0; position < samples; position += blockSize)
+		{
+			const int blockSamples = juce::jmin(blockSize, samples - position);
+			juce::AudioBuffer<SampleType> block(buffer.getArrayOfWritePointers(), 2, position, blockSamples);
+
+			if (gliding)
+			{
+				float frequencies[2];
+				glide(frequencies, position, sampleRate);
+
+				if (engineOnly)
+				{
+					parameters.frequency[0] = frequencies[0];
+					parameters.frequency[1] = frequencies[1];
+					parameters.update();
+				}
+				else
+				{
+					frequencyLowMid->setValueNotifyingHost(frequencyLowMid->convertTo0to1(frequencies[0]));
+					frequencyMidHigh->setValueNotifyingHost(frequencyMidHigh->convertTo0to1(frequencies[1]));
+				}
+			}
+
+			const auto start = juce::Time::getHighResolutionTicks();
+
+			if (engineOnly)
+			{
+				juce::ScopedNoDenormals noDenormals;
+				engine.process(block.getArrayOfWritePointers(), blockSamples, parameters);
+			}
+			else
+			{
+				processor.processBlock(block, midi);
+			}
+
+			const double blockSeconds = juce::Time::highResolutionTicksToSeconds(juce::Time::getHighResolutionTicks() - start);
+			seconds += blockSeconds;
+			maxBlockSeconds = juce::jmax(maxBlockSeconds, blockSeconds);
+		}
+
+		if (seconds < bestSeconds)
+		{
+			bestSeconds = seconds;
+			bestMaxBlockSeconds = maxBlockSeconds;
+		}
+	}
+
+	processor.releaseResources();
+
+	Result result;
+	result.sampleRate = sampleRate;
+	result.blockSize = blockSize;
+	result.samplesPerSecond = samples / bestSeconds;
+	result.nsPerSample = 1.0e9 * bestSeconds / samples;
+	result.realtimeFactor = m_seconds / bestSeconds;
+	result.meanBlockUs = 1.0e6 * bestSeconds * blockSize / samples;
+	result.maxBlockUs = 1.0e6 * bestMaxBlockSeconds;
+
+	return result;
+}
+
+Benchmark::Result Benchmark::runCrossover(int bands, int order, double sampleRate, int blockSize, Precision precision, Signal signal)
+{
+	switch (order)
+	{
+		case 4:  return runCrossover<4>(bands, sampleRate, blockSize, precision, signal);
+		case 8:  return runCrossover<8>(bands, sampleRate, blockSize, precision, signal);
+		default: return runCrossover<2>(bands, sampleRate, blockSize, precision, signal);
+	}
+}
+
+template <int Order>
+Benchmark::Result Benchmark::runCrossover(int bands, double sampleRate, int blockSize, Precision precision, Signal signal)
+{
+	switch (bands)
+	{
+		case 2:  return runCrossover<2, Order>(sampleRate, blockSize, precision, signal);
+		case 3:  return runCrossover<3, Order>(sampleRate, blockSize, precision, signal);
+		case 4:  return runCrossover<4, Order>(sampleRate, blockSize, precision, signal);
+		case 5:  return runCrossover<5, Order>(sampleRate, blockSize, precision, signal);
+		case 6:  return runCrossover<6, Order>(sampleRate, blockSize, precision, signal);
+		case 7:  return runCrossover<7, Order>(sampleRate, blockSize, precision, signal);
+		default: return runCrossover<8, Order>(sampleRate, blockSize, precision, signal);
+	}
+}
+
+template <int NumBands, int Order>
+Benchmark::Result Benchmark::runCrossover(double sampleRate, int blockSize, Precision precision, Signal signal)
+{
+	const int samples = (int)(m_seconds * sampleRate);
+
+	juce::AudioBuffer<float> input(2, samples);
+	generate(input, sampleRate, signal);
+
+	juce::AudioBuffer<double> inputDouble;
+	inputDouble.makeCopyOf(input);
+
+	Result result;
+	double bestSeconds = std::numeric_limits<double>::max();
+	double bestMaxBlockSeconds = 0.0;
+
+	for (int repeat = 0; repeat < m_repeats; ++repeat)
+	{
+		double maxBlockSeconds = 0.0;
+		const double seconds = precision == Precision::Double ? renderCrossover<NumBands, Order, double>(inputDouble, nullptr, sampleRate, blockSize, maxBlockSeconds)
+		                                                      : renderCrossover<NumBands, Order, float>(input, nullptr, sampleRate, blockSize, maxBlockSeconds);
+
+		if (seconds < bestSeconds)
+		{
+			bestSeconds = seconds;
+			bestMaxBlockSeconds = maxBlockSeconds;
+		}
+	}
+
+	// Untimed pass comparing every band sample of the single precision path with the double one
+	if (precision == Precision::Single)
+	{
+		juce::AudioBuffer<float> output(2 * NumBands, samples);
+		juce::AudioBuffer<double> reference(2 * NumBands, samples);
+		double maxBlockSeconds = 0.0;
+		renderCrossover<NumBands, Order>(input, &output, sampleRate, blockSize, maxBlockSeconds);
+		renderCrossover<NumBands, Order>(inputDouble, &reference, sampleRate, blockSize, maxBlockSeconds);
+
+		for (int channel = 0; channel < 2 * NumBands; ++channel)
+			for (int sample = 0; sample < samples; ++sample)
+				result.maxError = juce::jmax(result.maxError, std::abs((double)output.getSample(channel, sample) - reference.getSample(channel, sample)));
+	}
+
+	result.sampleRate = sampleRate;
+	result.blockSize = blockSize;
+	result.samplesPerSecond = samples / bestSeconds;
+	result.nsPerSample = 1.0e9 * bestSeconds / samples;
+	result.realtimeFactor = m_seconds / bestSeconds;
+	result.meanBlockUs = 1.0e6 * bestSeconds * blockSize / samples;
+	result.maxBlockUs = 1.0e6 * bestMaxBlockSeconds;
+
+	return result;
+}
+
+template <int NumBands, int Order, typename SampleType>
+double Benchmark::renderCrossover(const juce::AudioBuffer<SampleType>& input, juce::AudioBuffer<SampleType>* output, double sampleRate, int blockSize,
+                                  double& maxBlockSeconds)
+{
+	const int samples = input.getNumSamples();
+
+	// Crossovers spread evenly in log frequency between 80 Hz and 8 kHz
+	float frequencies[NumBands - 1];
+	for (int crossover = 0; crossover < NumBands - 1; ++crossover)
+		frequencies[crossover] = 80.0f * std::pow(100.0f, (float)(crossover + 1) / (float)NumBands);
+
+	CrossoverTree<NumBands, Order, SampleType> crossover;
+	crossover.init((int)sampleRate);
+	crossover.setFrequencies(frequencies);
+
+	juce::AudioBuffer<SampleType> bands(2 * NumBands, blockSize);
+	double seconds = 0.0;
+	maxBlockSeconds = 0.0;
+
+	for (int position = 0; position < samples; position += blockSize)
+	{
+		const int blockSamples = juce::jmin(blockSize, samples - position);
+		const auto start = juce::Time::getHighResolutionTicks();
+
+		crossover.template process<false>(input.getReadPointer(0, position), input.getReadPointer(1, position),
+		                                  bands.getArrayOfWritePointers(), blockSamples);
+
+		const double blockSeconds = juce::Time::highResolutionTicksToSeconds(juce::Time::getHighResolutionTicks() - start);
+		seconds += blockSeconds;
+		maxBlockSeconds = juce::jmax(maxBlockSeconds, blockSeconds);
+
+		if (output != nullptr)
+			for (int channel = 0; channel < 2 * NumBands; ++channel)
+				output->copyFrom(channel, position, bands, channel, 0, blockSamples);
+	}
+
+	return seconds;
+}
+
+Benchmark::StateResult Benchmark::runStateLoad(int instances)
+{
+	StateResult result;
+	result.instances = instances;
+
+	std::vector<std::unique_ptr<MultibandMSAudioProcessor>> processors;
+	processors.reserve((size_t)instances);
+
+	const auto createStart = juce::Time::getHighResolutionTicks();
+
+	for (int instance = 0; instance < instances; ++instance)
+		processors.push_back(std::make_unique<MultibandMSAudioProcessor>());
+
+	result.createMs = 1000.0 * juce::Time::highResolutionTicksToSeconds(juce::Time::getHighResolutionTicks() - createStart);
+
+	// Loads go back and forth between the defaults and a state away from them, so every timed load has values to apply
+	MultibandMSAudioProcessor source;
+	juce::MemoryBlock defaults;
+	source.getStateInformation(defaults);
+
+	for (int index = 0; index < MultibandMSAudioProcessor::N_PARAMETERS; ++index)
+		source.apvts.getParameter(MultibandMSAudioProcessor::paramsNames[index])->setValueNotifyingHost(0.3f);
+
+	juce::MemoryBlock binary;
+	source.getStateInformation(binary);
+
+	juce::MemoryBlock xml;
+	std::unique_ptr<juce::XmlElement> tree(source.apvts.copyState().createXml());
+	juce::AudioProcessor::copyXmlToBinary(*tree, xml);
+
+	result.stateBytes = binary.getSize();
+	result.xmlStateBytes = xml.getSize();
+
+	auto timeLoads = [&](const juce::MemoryBlock& state)
+	{
+		for (auto& processor : processors)
+			processor->setStateInformation(defaults.getData(), (int)defaults.getSize());
+
+		const auto start = juce::Time::getHighResolutionTicks();
+
+		for (auto& processor : processors)
+			processor->setStateInformation(state.getData(), (int)state.getSize());
+
+		return 1000.0 * juce::Time::highResolutionTicksToSeconds(juce::Time::getHighResolutionTicks() - start);
+	};
+
+	result.saveMs = std::numeric_limits<double>::max();
+	result.loadMs = std::numeric_limits<double>::max();
+	result.loadXmlMs = std::numeric_limits<double>::max();
+
+	for (int repeat = 0; repeat < m_repeats; ++repeat)
+	{
+		result.loadMs = juce::jmin(result.loadMs, timeLoads(binary));
+		result.loadXmlMs = juce::jmin(result.loadXmlMs, timeLoads(xml));
+
+		juce::MemoryBlock saved;
+		const auto start = juce::Time::getHighResolutionTicks();
+
+		for (auto& processor : processors)
+			processor->getStateInformation(saved);
+
+		result.saveMs = juce::jmin(result.saveMs, 1000.0 * juce::Time::highResolutionTicksToSeconds(juce::Time::getHighResolutionTicks() - start));
+	}
+
+	return result;
+}
+
+void Benchmark::printHeader()
+{
+	std::cout << juce::String("rate").paddedLeft(' ', 8)
+	          << juce::String("block").paddedLeft(' ', 8)
+	          << juce::String("samples/s").paddedLeft(' ', 16)
+	          << juce::String("ns/sample").paddedLeft(' ', 12)
+	          << juce::String("realtime").paddedLeft(' ', 12)
+	          << juce::String("us/block").paddedLeft(' ', 12)
+	          << juce::String("max us").paddedLeft(' ', 12) << std::endl;
+}
+
+void Benchmark::print(const Result& result)
+{
+	std::cout << juce::String((int)result.sampleRate).paddedLeft(' ', 8)
+	          << juce::String(result.blockSize).paddedLeft(' ', 8)
+	          << juce::String(result.samplesPerSecond, 0).paddedLeft(' ', 16)
+	          << juce::String(result.nsPerSample, 2).paddedLeft(' ', 12)
+	          << (juce::String(result.realtimeFactor, 1) + "x").paddedLeft(' ', 12)
+	          << juce::String(result.meanBlockUs, 1).paddedLeft(' ', 12)
+	          << juce::String(result.maxBlockUs, 1).paddedLeft(' ', 12) << std::endl;
+}
+
+void Benchmark::print(const StateResult& result)
+{
+	std::cout << result.instances << " instances" << std::endl
+	          << "create:          " << juce::String(result.createMs, 2) << " ms" << std::endl
+	          << "save:            " << juce::String(result.saveMs, 2) << " ms, " << (int)result.stateBytes << " bytes each" << std::endl
+	          << "load binary:     " << juce::String(result.loadMs, 2) << " ms" << std::endl
+	          << "load XML (old):  " << juce::String(result.loadXmlMs, 2) << " ms, " << (int)result.xmlStateBytes << " bytes each" << std::endl;
+}
@@ -0,0 +1,97 @@
+/*
+  ==============================================================================
+
+    Throughput benchmark for MultibandMSAudioProcessor::processBlock.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+//==============================================================================
+class Benchmark
+{
+public:
+	enum class Signal
+	{
+		Noise,
+		Sine,
+		Tail, // fade out and silence every second, filter states decay towards subnormals
+		Glide // noise with FreqLM and FreqMH sweeping every block, in linear phase mode, where filters are redesigned
+	};
+
+	enum class Precision
+	{
+		Single,
+		Double
+	};
+
+	struct Result
+	{
+		double sampleRate = 0.0;
+		int blockSize = 0;
+		double samplesPerSecond = 0.0;
+		double nsPerSample = 0.0;
+		double realtimeFactor = 0.0;
+
+		// Microseconds per block of the fastest run. A block slower than its own duration is a dropout,
+		// however good the mean, so the slowest one is reported too.
+		double meanBlockUs = 0.0;
+		double maxBlockUs = 0.0;
+
+		// Largest band output difference from a double precision run, crossover benchmarks only
+		double maxError = 0.0;
+	};
+
+	// Milliseconds for all instances together
+	struct StateResult
+	{
+		int instances = 0;
+		double createMs = 0.0;
+		double saveMs = 0.0;
+		double loadMs = 0.0;    // binary state
+		double loadXmlMs = 0.0; // XML state, as saved by earlier versions
+		size_t stateBytes = 0;
+		size_t xmlStateBytes = 0;
+	};
+
+	Benchmark(double seconds, int repeats);
+
+	// Processes 'seconds' of the signal in blocks of blockSize; best of 'repeats' runs
+	Result run(double sampleRate, int blockSize, Signal signal, Precision precision, const juce::ArgumentList& args);
+
+	// Times CrossoverTree<bands, order>::process alone, bands from 2 to 8, order 2, 4 or 8
+	Result runCrossover(int bands, int order, double sampleRate, int blockSize, Precision precision, Signal signal);
+
+	// Creates the instances, then times saving and loading all their states, as in a session load or host autosave
+	StateResult runStateLoad(int instances);
+
+	static Signal parseSignal(const juce::String& name);
+	static Precision parsePrecision(const juce::String& name);
+	static void printHeader();
+	static void print(const Result& result);
+	static void print(const StateResult& result);
+
+private:
+	template <typename SampleType>
+	Result run(double sampleRate, int blockSize, Signal signal, const juce::ArgumentList& args);
+
+	template <int Order>
+	Result runCrossover(int bands, double sampleRate, int blockSize, Precision precision, Signal signal);
+	template <int NumBands, int Order>
+	Result runCrossover(double sampleRate, int blockSize, Precision precision, Signal signal);
+	// Splits input with a fresh crossover and returns the seconds taken, and those of the slowest block in
+	// maxBlockSeconds; bands are copied to output if given
+	template <int NumBands, int Order, typename SampleType>
+	double renderCrossover(const juce::AudioBuffer<SampleType>& input, juce::AudioBuffer<SampleType>* output, double sampleRate, int blockSize,
+	                       double& maxBlockSeconds);
+
+	static void generate(juce::AudioBuffer<float>& buffer, double sampleRate, Signal signal);
+	// Crossover frequencies of the glide at a position, a sine sweep over the FreqLM and FreqMH ranges
+	static void glide(float* frequencies, int position, double sampleRate);
+
+	double m_seconds;
+	int m_repeats;
+};
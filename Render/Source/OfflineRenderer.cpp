@@ -0,0 +1,196 @@
+/*
+  ==============================================================================
+
+    Offline rendering of audio files through the MultibandMS engine.
+
+  ==============================================================================
+*/
+
+#include "OfflineRenderer.h"
+
+//==============================================================================
+OfflineRenderer::OfflineRenderer(int blockSize) : m_blockSize(blockSize), m_block(2, blockSize)
+{
+	m_formatManager.registerBasicFormats();
+}
+
+void OfflineRenderer::prepare(MultibandMSAudioProcessor& processor, double sampleRate, int blockSize)
+{
+	processor.setPlayConfigDetails(2, 2, sampleRate, blockSize);
+	processor.setNonRealtime(true);
+	processor.prepareToPlay(sampleRate, blockSize);
+}
+
+void OfflineRenderer::applyParameters(MultibandMSAudioProcessor& processor, const juce::ArgumentList& args)
+{
+	for (const auto& arg : args.arguments)
+	{
+		if (!arg.isLongOption() || !arg.text.containsChar('='))
+			continue;
+
+		const auto name = arg.text.fromFirstOccurrenceOf("--", false, false).upToFirstOccurrenceOf("=", false, false);
+
+		if (auto* parameter = processor.apvts.getParameter(name))
+		{
+			const float value = arg.getLongOptionValue().getFloatValue();
+			parameter->setValueNotifyingHost(parameter->convertTo0to1(value));
+		}
+	}
+}
+
+ParameterSnapshot OfflineRenderer::readSnapshot(const juce::ArgumentList& args)
+{
+	ParameterSnapshot snapshot;
+	const auto* names = MultibandMSAudioProcessor::paramsNames;
+
+	auto read = [&args](const std::string& name, float value)
+	{
+		const auto option = "--" + juce::String(name);
+		return args.containsOption(option) ? args.getValueForOption(option).getFloatValue() : value;
+	};
+
+	snapshot.width[0] = read(names[0], snapshot.width[0]);
+	snapshot.frequency[0] = read(names[1], snapshot.frequency[0]);
+	snapshot.width[1] = read(names[2], snapshot.width[1]);
+	snapshot.frequency[1] = read(names[3], snapshot.frequency[1]);
+	snapshot.width[2] = read(names[4], snapshot.width[2]);
+	snapshot.volume = read(names[5], snapshot.volume);
+	snapshot.slope = juce::jlimit(0, MultibandMSAudioProcessor::slopeNames.size() - 1, (int)read(names[6], 0.0f));
+	snapshot.linearPhase = read(names[7], 0.0f) >= 0.5f;
+	snapshot.oversampling = juce::jlimit(0, MultibandEngine::MAX_OVERSAMPLING, (int)read(names[8], 0.0f));
+	snapshot.update();
+
+	return snapshot;
+}
+
+SimdKernel OfflineRenderer::readKernel(const juce::ArgumentList& args)
+{
+	if (!args.containsOption("--kernel"))
+		return SimdKernel::Auto;
+
+	const auto name = args.getValueForOption("--kernel");
+	const auto kernel = findKernel(name.toRawUTF8());
+
+	if (kernel == SimdKernel::Auto && !name.equalsIgnoreCase("auto"))
+		juce::ConsoleApplication::fail("Unknown kernel " + name);
+
+	return kernel;
+}
+
+void OfflineRenderer::prepare(MultibandEngine& engine, double sampleRate, int blockSize, const ParameterSnapshot& parameters)
+{
+	engine.prepare(sampleRate, blockSize, 2, { { 0, 1 } }, parameters);
+}
+
+juce::String OfflineRenderer::render(const juce::File& input, const juce::File& output, const ParameterSnapshot& parameters)
+{
+	m_processingSeconds = 0.0;
+	m_processedSamples = 0;
+	m_processedSeconds = 0.0;
+
+	// The output is deleted before writing, which would take the input with it, mapped or not
+	if (output == input)
+		return "Output would replace its input " + input.getFullPathName();
+
+	// WAV and AIFF are read straight from a window of the file mapped into memory, which saves the
+	// stream reader's copy into its own buffer. Other formats go through the stream reader.
+	juce::MemoryMappedAudioFormatReader* mapped = nullptr;
+	std::unique_ptr<juce::AudioFormatReader> reader;
+
+	const int mapWindow = juce::jmax(MAP_WINDOW_SAMPLES, m_blockSize);
+
+	if (auto* format = m_formatManager.findFormatForFileExtension(input.getFileExtension()))
+		reader.reset(mapped = format->createMemoryMappedReader(input));
+
+	if (mapped != nullptr && !mapped->mapSectionOfFile({ 0, juce::jmin(mapped->lengthInSamples, (juce::int64)mapWindow) }))
+	{
+		reader.reset();
+		mapped = nullptr;
+	}
+
+	if (reader == nullptr)
+		reader.reset(m_formatManager.createReaderFor(input));
+
+	if (reader == nullptr)
+		return "Could not read " + input.getFullPathName();
+
+	const double sampleRate = reader->sampleRate;
+	const juce::int64 length = reader->lengthInSamples;
+	const int numChannels = (int)reader->numChannels;
+
+	if (numChannels <= 0)
+		return "No audio channels in " + input.getFullPathName();
+
+	// Channel roles from the file where it has them, so a 5.1 file pairs up the way the plugin's 5.1 bus does
+	auto layout = reader->getChannelLayout();
+	if (layout.size() != numChannels)
+		layout = juce::AudioChannelSet::discreteChannels(numChannels);
+
+	output.deleteFile();
+	std::unique_ptr<juce::FileOutputStream> stream(output.createOutputStream(WRITE_BUFFER_SIZE));
+	if (stream == nullptr)
+		return "Could not write " + output.getFullPathName();
+
+	const int bitDepth = juce::jmax(16, (int)reader->bitsPerSample);
+
+	juce::WavAudioFormat wav;
+	std::unique_ptr<juce::AudioFormatWriter> writer(wav.createWriterFor(stream.get(), sampleRate, layout, bitDepth, {}, 0));
+
+	// Roles WAV has no speaker bits for go out as discrete channels, in the same order
+	if (writer == nullptr)
+		writer.reset(wav.createWriterFor(stream.get(), sampleRate, juce::AudioChannelSet::discreteChannels(numChannels), bitDepth, {}, 0));
+
+	if (writer == nullptr)
+		return "Unsupported output format for " + output.getFullPathName();
+
+	// The writer owns the stream from here on
+	stream.release();
+
+	// The engine directly, as the render farm embeds it, without hosting the plugin
+	std::vector<ChannelPair> pairs;
+	addChannelPairs(pairs, layout, 0);
+
+	m_block.setSize(numChannels, m_blockSize, false, false, true);
+	m_engine.prepare(sampleRate, m_blockSize, numChannels, pairs, parameters);
+
+	juce::ScopedNoDenormals noDenormals;
+	juce::int64 processingTicks = 0;
+
+	// The engine output lags by its latency, which is dropped from the start, and the input runs on with
+	// silence until the delayed end and the filter tails are out, so the file lines up with its source
+	const int latency = m_engine.getLatency();
+	const juce::int64 processedLength = length + latency + m_engine.getTailSamples();
+
+	for (juce::int64 position = 0; position < processedLength; position += m_blockSize)
+	{
+		const int blockSamples = (int)juce::jmin((juce::int64)m_blockSize, processedLength - position);
+		const int inputSamples = (int)juce::jlimit((juce::int64)0, (juce::int64)blockSamples, length - position);
+
+		if (inputSamples > 0)
+		{
+			// The window slides along the file, so only the pages in use stay resident, whatever the length
+			if (mapped != nullptr && !mapped->getMappedSection().contains({ position, position + inputSamples }))
+				if (!mapped->mapSectionOfFile({ position, juce::jmin(length, position + mapWindow) }))
+					return "Could not map " + input.getFullPathName();
+
+			reader->read(&m_block, 0, inputSamples, position, true, true);
+		}
+
+		m_block.clear(inputSamples, blockSamples - inputSamples);
+
+		const auto start = juce::Time::getHighResolutionTicks();
+		m_engine.process(m_block.getArrayOfWritePointers(), blockSamples, parameters);
+		processingTicks += juce::Time::getHighResolutionTicks() - start;
+
+		const int skipped = (int)juce::jlimit((juce::int64)0, (juce::int64)blockSamples, (juce::int64)latency - position);
+
+		if (skipped < blockSamples && !writer->writeFromAudioSampleBuffer(m_block, skipped, blockSamples - skipped))
+			return "Could not write " + output.getFullPathName();
+	}
+
+	m_processingSeconds = juce::Time::highResolutionTicksToSeconds(processingTicks);
+	m_processedSamples = length;
+	m_processedSeconds = sampleRate > 0.0 ? (double)length / sampleRate : 0.0;
+
+	return {};
+}
@@ -0,0 +1,62 @@
+/*
+  ==============================================================================
+
+    Offline rendering of audio files through the MultibandMS engine.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "../../Source/PluginProcessor.h"
+
+//==============================================================================
+class OfflineRenderer
+{
+public:
+	OfflineRenderer(int blockSize);
+
+	// Sets up processor channels, sample rate and block size, then calls prepareToPlay
+	static void prepare(MultibandMSAudioProcessor& processor, double sampleRate, int blockSize);
+
+	// Applies "--<ParamName>=<value>" options, e.g. "--Low=1.5 --FreqLM=300"
+	static void applyParameters(MultibandMSAudioProcessor& processor, const juce::ArgumentList& args);
+
+	// The same options as engine parameters, starting from the plugin defaults; Compare and Morph do not apply
+	static ParameterSnapshot readSnapshot(const juce::ArgumentList& args);
+
+	// "--kernel=scalar|sse2|avx2|neon" forces a crossover kernel, Auto without; fails on unknown names
+	static SimdKernel readKernel(const juce::ArgumentList& args);
+
+	// Sets up the engine for one stereo pair in channels 0 and 1
+	static void prepare(MultibandEngine& engine, double sampleRate, int blockSize, const ParameterSnapshot& parameters);
+
+	// Streams input through the engine into a WAV file, holding one block in memory whatever the file
+	// length. Every channel is processed, paired as the plugin pairs a bus of the file's layout, and
+	// written in the same layout. The output starts in line with the input, the engine latency
+	// removed, and runs on by the engine tail. Returns an error message, or empty string on success.
+	juce::String render(const juce::File& input, const juce::File& output, const ParameterSnapshot& parameters);
+
+	void setKernel(SimdKernel kernel) { m_engine.setKernel(kernel); }
+
+	// Engine time alone and file length, of the last render
+	double getProcessingSeconds() const { return m_processingSeconds; }
+	juce::int64 getProcessedSamples() const { return m_processedSamples; }
+	double getProcessedSeconds() const { return m_processedSeconds; }
+
+private:
+	static const int MAP_WINDOW_SAMPLES = 1 << 20; // per mapping, 6 MB of 24 bit stereo
+	static const int WRITE_BUFFER_SIZE = 1 << 20;  // bytes
+
+	int m_blockSize;
+	double m_processingSeconds = 0.0;
+	juce::int64 m_processedSamples = 0;
+	double m_processedSeconds = 0.0;
+
+	// Reused from file to file, prepared again for each, the block sized to the file's channels
+	MultibandEngine m_engine;
+	juce::AudioBuffer<float> m_block;
+
+	juce::AudioFormatManager m_formatManager;
+};
@@ -0,0 +1,750 @@
+/*
+  ==============================================================================
+
+    Numerical accuracy checks of the filters, crossover kernels and engine.
+
+  ==============================================================================
+*/
+
+#include "Verification.h"
+#include "OfflineRenderer.h"
+
+//==============================================================================
+namespace
+{
+	const double pi = 3.141592653589793;
+	const float crossoverFrequencies[2] = { 440.0f, 3520.5f };
+
+	// One Linkwitz-Riley crossover point from the scalar filters, the reference for the stereo kernels
+	template <int Order>
+	class ScalarCrossover
+	{
+	public:
+		static const int N_SECTIONS = Order == 2 ? 1 : Order / 2;
+
+		void init(int sampleRate, double frequency)
+		{
+			for (int section = 0; section < N_SECTIONS; ++section)
+			{
+				m_sections[section].init(sampleRate);
+				m_sections[section].setFrequency(frequency, Order == 2 ? 0.5 : butterworthQ(Order / 2, section % juce::jmax(1, Order / 4)));
+			}
+		}
+
+		double processLP(double in)
+		{
+			for (auto& section : m_sections)
+				in = section.processLP(in);
+
+			return in;
+		}
+
+		double processHP(double in)
+		{
+			for (auto& section : m_sections)
+				in = section.processHP(in);
+
+			return in;
+		}
+
+	private:
+		LinkwitzRileySecondOrder<double> m_sections[N_SECTIONS];
+	};
+
+	// The all-pass a ScalarCrossover of the same Order sums to
+	template <int Order>
+	class ScalarAllPass
+	{
+	public:
+		void init(int sampleRate, double frequency)
+		{
+			m_firstOrder.init(sampleRate);
+			m_firstOrder.setFrequency(frequency);
+
+			for (int section = 0; section < Order / 4; ++section)
+			{
+				m_secondOrder[section].init(sampleRate);
+				m_secondOrder[section].setFrequency(frequency, butterworthQ(Order / 2, section));
+			}
+		}
+
+		double process(double in)
+		{
+			if (Order == 2)
+				return m_firstOrder.process(in);
+
+			for (int section = 0; section < Order / 4; ++section)
+				in = m_secondOrder[section].process(in);
+
+			return in;
+		}
+
+	private:
+		FirstOrderAllPass<double> m_firstOrder;
+		SecondOrderAllPass<double> m_secondOrder[2];
+	};
+
+	// Three band split of one channel, laid out as CrossoverTree<3, Order> splits it
+	template <int Order>
+	class ScalarTree
+	{
+	public:
+		void init(int sampleRate)
+		{
+			m_low.init(sampleRate, crossoverFrequencies[0]);
+			m_high.init(sampleRate, crossoverFrequencies[1]);
+			m_compensation.init(sampleRate, crossoverFrequencies[1]);
+		}
+
+		void process(double in, double* bands)
+		{
+			const double rest = m_low.processHP(in);
+
+			bands[0] = m_compensation.process(m_low.processLP(in));
+			bands[1] = m_high.processLP(rest);
+			bands[2] = m_high.processHP(rest);
+		}
+
+	private:
+		ScalarCrossover<Order> m_low;
+		ScalarCrossover<Order> m_high;
+		ScalarAllPass<Order> m_compensation;
+	};
+
+	template <typename SampleType>
+	const char* precisionName()
+	{
+		return std::is_same<SampleType, double>::value ? "double" : "float";
+	}
+}
+
+//==============================================================================
+Verification::Verification(double sampleRate) : m_sampleRate(sampleRate)
+{
+	// Long enough for the slowest IIR tail and the linear phase latency to die out
+	m_impulseLength = juce::nextPowerOfTwo(juce::roundToInt(sampleRate));
+
+	for (double frequency = 20.0; frequency < 0.45 * sampleRate; frequency *= std::pow(2.0, 1.0 / 3.0))
+		m_frequencies.push_back(frequency);
+}
+
+std::vector<Verification::Check> Verification::run()
+{
+	std::vector<Check> checks;
+
+	checkFilterResponses<double>(checks);
+	checkFilterResponses<float>(checks);
+
+	checkKernel<2, double>(checks);
+	checkKernel<4, double>(checks);
+	checkKernel<8, double>(checks);
+	checkKernel<2, float>(checks);
+	checkKernel<4, float>(checks);
+	checkKernel<8, float>(checks);
+
+	checkTreeReconstruction<2, double>(checks);
+	checkTreeReconstruction<4, double>(checks);
+	checkTreeReconstruction<8, double>(checks);
+	checkTreeReconstruction<2, float>(checks);
+	checkTreeReconstruction<4, float>(checks);
+	checkTreeReconstruction<8, float>(checks);
+
+	checkKernelDispatch<double>(checks);
+	checkKernelDispatch<float>(checks);
+
+	checkEngineReconstruction<double>(checks);
+	checkEngineReconstruction<float>(checks);
+
+	checkBypassResume(checks);
+	checkRenderAlignment(checks);
+	checkStateLoading(checks);
+
+	return checks;
+}
+
+void Verification::print(const Check& check)
+{
+	std::cout << (check.passed() ? "ok    " : "FAIL  ") << check.name << ": " << check.error << " " << check.unit
+	          << " (tolerance " << check.tolerance << ")" << std::endl;
+}
+
+//==============================================================================
+template <typename SampleType>
+void Verification::checkFilterResponses(std::vector<Check>& checks)
+{
+	// Single precision keeps its coefficients and states in float, which shows most at low crossovers with
+	// high Q: a 100 Hz section deviates by up to 0.07 dB at 48 kHz, and more as the sample rate rises
+	const bool single = std::is_same<SampleType, float>::value;
+	const double magnitudeTolerance = single ? 0.1 : 1.0e-6;
+	const double phaseTolerance = single ? 0.25 : 1.0e-4;
+	const juce::String precision = precisionName<SampleType>();
+	const int sampleRate = juce::roundToInt(m_sampleRate);
+
+	// Responses of the prototypes at the prewarped frequency ratio, which the bilinear transform matches exactly
+	auto ratio = [this](double frequency, double cutoff)
+	{
+		return std::tan(pi * frequency / m_sampleRate) / std::tan(pi * cutoff / m_sampleRate);
+	};
+
+	const std::complex<double> j(0.0, 1.0);
+	std::vector<double> impulse((size_t)m_impulseLength);
+
+	for (const double cutoff : { 100.0, 1000.0, 5000.0 })
+	{
+		const juce::String at = " " + precision + " at " + juce::String(cutoff) + " Hz";
+
+		FirstOrderAllPass<SampleType> firstOrder;
+		firstOrder.init(sampleRate);
+		firstOrder.setFrequency((SampleType)cutoff);
+
+		for (int sample = 0; sample < m_impulseLength; ++sample)
+			impulse[(size_t)sample] = (double)firstOrder.process(sample == 0 ? (SampleType)1 : (SampleType)0);
+
+		compareResponse(checks, "FirstOrderAllPass" + at, impulse, [&](double frequency)
+		{
+			const double w = ratio(frequency, cutoff);
+			return (1.0 - j * w) / (1.0 + j * w);
+		}, magnitudeTolerance, phaseTolerance);
+
+		for (const double q : { butterworthQ(2, 0), butterworthQ(4, 0), butterworthQ(4, 1) })
+		{
+			const juce::String withQ = at + ", Q " + juce::String(q, 3);
+
+			SecondOrderAllPass<SampleType> secondOrder;
+			secondOrder.init(sampleRate);
+			secondOrder.setFrequency((SampleType)cutoff, (SampleType)q);
+
+			for (int sample = 0; sample < m_impulseLength; ++sample)
+				impulse[(size_t)sample] = (double)secondOrder.process(sample == 0 ? (SampleType)1 : (SampleType)0);
+
+			compareResponse(checks, "SecondOrderAllPass" + withQ, impulse, [&](double frequency)
+			{
+				const double w = ratio(frequency, cutoff);
+				return (1.0 - w * w - j * w / q) / (1.0 - w * w + j * w / q);
+			}, magnitudeTolerance, phaseTolerance);
+		}
+
+		for (const double q : { 0.5, butterworthQ(2, 0) })
+		{
+			const juce::String withQ = at + ", Q " + juce::String(q, 3);
+
+			LinkwitzRileySecondOrder<SampleType> section;
+			section.init(sampleRate);
+			section.setFrequency((SampleType)cutoff, (SampleType)q);
+
+			for (int sample = 0; sample < m_impulseLength; ++sample)
+				impulse[(size_t)sample] = (double)section.processLP(sample == 0 ? (SampleType)1 : (SampleType)0);
+
+			compareResponse(checks, "LinkwitzRileySecondOrder LP" + withQ, impulse, [&](double frequency)
+			{
+				const double w = ratio(frequency, cutoff);
+				return 1.0 / (1.0 - w * w + j * w / q);
+			}, magnitudeTolerance, phaseTolerance);
+
+			// processHP inverts, so LP and HP of one section sum to an all-pass
+			for (int sample = 0; sample < m_impulseLength; ++sample)
+				impulse[(size_t)sample] = (double)section.processHP(sample == 0 ? (SampleType)1 : (SampleType)0);
+
+			compareResponse(checks, "LinkwitzRileySecondOrder HP" + withQ, impulse, [&](double frequency)
+			{
+				const double w = ratio(frequency, cutoff);
+				return (w * w) / (1.0 - w * w + j * w / q);
+			}, magnitudeTolerance, phaseTolerance);
+		}
+	}
+}
+
+template <int Order, typename SampleType>
+void Verification::checkKernel(std::vector<Check>& checks)
+{
+	const int sampleRate = juce::roundToInt(m_sampleRate);
+	const int samples = sampleRate;
+	const int blockSize = 512;
+	const bool single = std::is_same<SampleType, float>::value;
+	const juce::String suffix = juce::String(" LR") + juce::String(Order) + " " + precisionName<SampleType>();
+
+	CrossoverTree<3, Order, SampleType> tree;
+	CrossoverTree<3, Order, SampleType> monoTree;
+	tree.init(sampleRate);
+	tree.setFrequencies(crossoverFrequencies);
+	monoTree.init(sampleRate);
+	monoTree.setFrequencies(crossoverFrequencies);
+
+	ScalarTree<Order> reference[2];
+	for (auto& channel : reference)
+		channel.init(sampleRate);
+
+	juce::Random random(0x5a22);
+	std::vector<SampleType> input[2] = { std::vector<SampleType>((size_t)samples), std::vector<SampleType>((size_t)samples) };
+	for (int sample = 0; sample < samples; ++sample)
+	{
+		input[0][(size_t)sample] = (SampleType)(random.nextFloat() - 0.5f);
+		input[1][(size_t)sample] = (SampleType)(random.nextFloat() - 0.5f);
+	}
+
+	std::vector<SampleType> bandData((size_t)(6 * blockSize));
+	std::vector<SampleType> monoData((size_t)(6 * blockSize));
+	SampleType* bands[6];
+	SampleType* monoBands[6];
+	for (int channel = 0; channel < 6; ++channel)
+	{
+		bands[channel] = bandData.data() + channel * blockSize;
+		monoBands[channel] = monoData.data() + channel * blockSize;
+	}
+
+	double stereoError = 0.0;
+	double monoError = 0.0;
+
+	// Blocks, so the state copies and the denormal flush between them are covered too
+	for (int position = 0; position < samples; position += blockSize)
+	{
+		const int block = juce::jmin(blockSize, samples - position);
+		tree.template process<false>(input[0].data() + position, input[1].data() + position, bands, block);
+		monoTree.template processMono<false>(input[0].data() + position, monoBands, block);
+
+		for (int sample = 0; sample < block; ++sample)
+		{
+			double expected[2][3];
+			reference[0].process((double)input[0][(size_t)(position + sample)], expected[0]);
+			reference[1].process((double)input[1][(size_t)(position + sample)], expected[1]);
+
+			for (int band = 0; band < 3; ++band)
+			{
+				for (int channel = 0; channel < 2; ++channel)
+					stereoError = juce::jmax(stereoError, std::abs((double)bands[2 * band + channel][sample] - expected[channel][band]));
+
+				monoError = juce::jmax(monoError, std::abs((double)monoBands[2 * band][sample] - (double)bands[2 * band][sample]));
+			}
+		}
+	}
+
+	checks.push_back({ "CrossoverTree stereo kernel vs scalar filters" + suffix, stereoError, single ? 1.0e-4 : 1.0e-10, "abs" });
+	checks.push_back({ "CrossoverTree mono kernel vs stereo kernel" + suffix, monoError, 0.0, "abs" });
+}
+
+template <int Order, typename SampleType>
+void Verification::checkTreeReconstruction(std::vector<Check>& checks)
+{
+	const int sampleRate = juce::roundToInt(m_sampleRate);
+	const bool single = std::is_same<SampleType, float>::value;
+
+	CrossoverTree<3, Order, SampleType> tree;
+	tree.init(sampleRate);
+	tree.setFrequencies(crossoverFrequencies);
+
+	// Width 1 and 0 dB, the defaults, make the band matrix direct 1 and cross 0
+	ParameterSnapshot parameters;
+	parameters.update();
+
+	std::vector<SampleType> left((size_t)m_impulseLength, (SampleType)0);
+	std::vector<SampleType> right((size_t)m_impulseLength, (SampleType)0);
+	left[0] = (SampleType)1;
+
+	juce::AudioBuffer<SampleType> bands(6, m_impulseLength);
+	tree.template process<false>(left.data(), right.data(), bands.getArrayOfWritePointers(), m_impulseLength);
+
+	std::vector<double> impulse((size_t)m_impulseLength, 0.0);
+	for (int band = 0; band < 3; ++band)
+		for (int sample = 0; sample < m_impulseLength; ++sample)
+			impulse[(size_t)sample] += parameters.matrix[band].direct * (double)bands.getSample(2 * band, sample)
+			                         + parameters.matrix[band].cross * (double)bands.getSample(2 * band + 1, sample);
+
+	checks.push_back({ juce::String("CrossoverTree band sum flatness LR") + juce::String(Order) + " " + precisionName<SampleType>(),
+	                   flatness(impulse), single ? 0.001 : 1.0e-6, "dB" });
+}
+
+template <typename SampleType>
+void Verification::checkKernelDispatch(std::vector<Check>& checks)
+{
+	const int sampleRate = juce::roundToInt(m_sampleRate);
+	const int samples = sampleRate;
+	const int blockSize = MultibandEngine::AUTOMATION_BLOCK_SIZE;
+	const bool single = std::is_same<SampleType, float>::value;
+	const float gliding[2] = { 200.0f, 5000.0f };
+	const char* slopes[] = { "12 dB", "24 dB", "48 dB" };
+
+	juce::Random random(0x5a22);
+	std::vector<SampleType> input[2] = { std::vector<SampleType>((size_t)samples), std::vector<SampleType>((size_t)samples) };
+	for (int sample = 0; sample < samples; ++sample)
+	{
+		input[0][(size_t)sample] = (SampleType)(random.nextFloat() - 0.5f);
+		input[1][(size_t)sample] = (SampleType)(random.nextFloat() - 0.5f);
+	}
+
+	juce::AudioBuffer<SampleType> expected(6, blockSize);
+	juce::AudioBuffer<SampleType> actual(6, blockSize);
+
+	for (const auto kernel : { SimdKernel::Sse2, SimdKernel::Avx2, SimdKernel::Neon })
+	{
+		if (!isKernelAvailable(kernel))
+			continue;
+
+		for (int slope = 0; slope < 3; ++slope)
+		{
+			for (const bool mono : { false, true })
+			{
+				auto reference = createBandSplitter<SampleType>(SimdKernel::Scalar);
+				auto splitter = createBandSplitter<SampleType>(kernel);
+
+				for (auto* state : { reference.get(), splitter.get() })
+				{
+					state->init(sampleRate);
+					state->reset(slope, crossoverFrequencies);
+				}
+
+				double error = 0.0;
+
+				// The middle third glides, so the coefficient ramps are compared too
+				for (int position = 0; position + blockSize <= samples; position += blockSize)
+				{
+					const float* frequencies = position >= samples / 3 && position < samples * 2 / 3 ? gliding : nullptr;
+					const SampleType* left = input[0].data() + position;
+					const SampleType* right = input[1].data() + position;
+
+					if (mono)
+					{
+						reference->splitMono(slope, left, expected.getArrayOfWritePointers(), blockSize, frequencies);
+						splitter->splitMono(slope, left, actual.getArrayOfWritePointers(), blockSize, frequencies);
+					}
+					else
+					{
+						reference->split(slope, left, right, expected.getArrayOfWritePointers(), blockSize, frequencies);
+						splitter->split(slope, left, right, actual.getArrayOfWritePointers(), blockSize, frequencies);
+					}
+
+					for (int channel = 0; channel < 6; channel += mono ? 2 : 1)
+						for (int sample = 0; sample < blockSize; ++sample)
+							error = juce::jmax(error, std::abs((double)actual.getSample(channel, sample) - (double)expected.getSample(channel, sample)));
+				}
+
+				// The same operations in the same order; only compilers fusing multiply-adds on some targets could differ
+				checks.push_back({ juce::String(getKernelName(kernel)) + " kernel vs scalar, " + slopes[slope] + (mono ? " mono " : " stereo ") + precisionName<SampleType>(),
+				                   error, single ? 1.0e-5 : 1.0e-12, "abs" });
+			}
+		}
+	}
+}
+
+template <typename SampleType>
+void Verification::checkEngineReconstruction(std::vector<Check>& checks)
+{
+	const int blockSize = 512;
+	const char* modes[] = { "12 dB", "24 dB", "48 dB", "linear phase" };
+
+	for (int mode = 0; mode < 4; ++mode)
+	{
+		ParameterSnapshot parameters;
+		parameters.slope = juce::jmin(mode, 2);
+		parameters.linearPhase = mode == 3;
+		parameters.update();
+
+		MultibandEngine engine;
+		engine.prepare(m_sampleRate, blockSize, 2, { { 0, 1 } }, parameters);
+
+		juce::AudioBuffer<SampleType> buffer(2, m_impulseLength);
+		buffer.clear();
+		buffer.setSample(0, 0, (SampleType)1);
+
+		juce::ScopedNoDenormals noDenormals;
+
+		for (int position = 0; position < m_impulseLength; position += blockSize)
+		{
+			SampleType* channels[2] = { buffer.getWritePointer(0, position), buffer.getWritePointer(1, position) };
+			engine.process(channels, juce::jmin(blockSize, m_impulseLength - position), parameters);
+		}
+
+		std::vector<double> impulse((size_t)m_impulseLength);
+		double leakage = 0.0;
+
+		for (int sample = 0; sample < m_impulseLength; ++sample)
+		{
+			impulse[(size_t)sample] = (double)buffer.getSample(0, sample);
+			leakage = juce::jmax(leakage, std::abs((double)buffer.getSample(1, sample)));
+		}
+
+		const juce::String name = juce::String("MultibandEngine ") + modes[mode] + " " + precisionName<SampleType>();
+
+		// The engine goes idle once its output falls below -120 dB, which cuts the IIR tails there
+		checks.push_back({ name + " flatness at width 1", flatness(impulse), 0.01, "dB" });
+		checks.push_back({ name + " crosstalk at width 1", leakage, 1.0e-6, "abs" });
+	}
+}
+
+void Verification::checkBypassResume(std::vector<Check>& checks)
+{
+	const int blockSize = 512;
+	const int bypassStart = (m_impulseLength / 4 / blockSize) * blockSize;
+	const int bypassEnd = (m_impulseLength / 2 / blockSize) * blockSize;
+	const double frequency = 1000.0;
+	const double amplitude = 0.5;
+	const double delta = 2.0 * juce::MathConstants<double>::pi * frequency / m_sampleRate;
+
+	for (const bool linearPhase : { false, true })
+	{
+		ParameterSnapshot parameters;
+		parameters.slope = 1;
+		parameters.linearPhase = linearPhase;
+		parameters.update();
+
+		// One engine runs throughout, the other is bypassed for a quarter of the sine
+		MultibandEngine reference;
+		MultibandEngine engine;
+		reference.prepare(m_sampleRate, blockSize, 2, { { 0, 1 } }, parameters);
+		engine.prepare(m_sampleRate, blockSize, 2, { { 0, 1 } }, parameters);
+
+		juce::AudioBuffer<float> expected(2, m_impulseLength);
+		for (int sample = 0; sample < m_impulseLength; ++sample)
+		{
+			expected.setSample(0, sample, (float)(amplitude * std::sin(delta * sample)));
+			expected.setSample(1, sample, (float)(amplitude * std::cos(delta * sample)));
+		}
+
+		juce::AudioBuffer<float> output;
+		output.makeCopyOf(expected);
+
+		juce::ScopedNoDenormals noDenormals;
+
+		for (int position = 0; position < m_impulseLength; position += blockSize)
+		{
+			const int samples = juce::jmin(blockSize, m_impulseLength - position);
+			float* expectedChannels[2] = { expected.getWritePointer(0, position), expected.getWritePointer(1, position) };
+			float* outputChannels[2] = { output.getWritePointer(0, position), output.getWritePointer(1, position) };
+
+			reference.process(expectedChannels, samples, parameters);
+
+			if (position >= bypassStart && position < bypassEnd)
+				engine.processBypassed(outputChannels, samples, parameters);
+			else
+				engine.process(outputChannels, samples, parameters);
+		}
+
+		const juce::String name = juce::String("MultibandEngine bypass ") + (linearPhase ? "linear phase" : "24 dB");
+
+		// States kept running underneath the bypass: the processed sound picks up where it would have been
+		double resumeError = 0.0;
+		for (int channel = 0; channel < 2; ++channel)
+			for (int sample = bypassEnd; sample < m_impulseLength; ++sample)
+				resumeError = juce::jmax(resumeError, std::abs((double)output.getSample(channel, sample) - expected.getSample(channel, sample)));
+
+		checks.push_back({ name + " resume against uninterrupted processing", resumeError, 1.0e-6, "abs" });
+
+		// At width 1 the linear phase crossover passes the sine as the bypass does, delayed by the latency,
+		// so neither edge of the bypass may step further than the sine itself does between samples
+		if (linearPhase)
+		{
+			const double sineStep = 2.0 * amplitude * std::sin(0.5 * delta);
+			double excess = 0.0;
+
+			for (int channel = 0; channel < 2; ++channel)
+			{
+				const float* samples = output.getReadPointer(channel);
+
+				for (int sample = bypassStart - blockSize; sample < m_impulseLength; ++sample)
+					excess = juce::jmax(excess, std::abs((double)samples[sample] - samples[sample - 1]) - sineStep);
+			}
+
+			checks.push_back({ name + " step beyond the sine's", excess, 1.0e-4, "abs" });
+		}
+	}
+}
+
+void Verification::checkRenderAlignment(std::vector<Check>& checks)
+{
+	const juce::File input = juce::File::createTempFile(".wav");
+	const juce::File output = juce::File::createTempFile(".wav");
+
+	{
+		juce::AudioBuffer<float> impulse(2, m_impulseLength);
+		impulse.clear();
+		impulse.setSample(0, 0, 0.5f);
+		impulse.setSample(1, 0, 0.5f);
+
+		juce::WavAudioFormat wav;
+		std::unique_ptr<juce::AudioFormatWriter> writer(wav.createWriterFor(input.createOutputStream().release(), m_sampleRate, 2, 24, {}, 0));
+		if (writer != nullptr)
+			writer->writeFromAudioSampleBuffer(impulse, 0, m_impulseLength);
+	}
+
+	juce::AudioFormatManager formatManager;
+	formatManager.registerBasicFormats();
+	OfflineRenderer renderer(512);
+
+	// Every latency the engine can report: the oversampling FIRs of each factor and the linear phase crossover
+	for (int mode = 0; mode <= MultibandEngine::MAX_OVERSAMPLING + 1; ++mode)
+	{
+		ParameterSnapshot parameters;
+		parameters.linearPhase = mode > MultibandEngine::MAX_OVERSAMPLING;
+		parameters.oversampling = parameters.linearPhase ? 0 : mode;
+		parameters.update();
+
+		const juce::String name = "OfflineRenderer impulse onset, " + (parameters.linearPhase ? juce::String("linear phase")
+		                                                                                      : juce::String(1 << mode) + "x oversampling");
+
+		// A render that fails shows as an onset at the end of the file
+		double onset = (double)m_impulseLength;
+
+		if (renderer.render(input, output, parameters).isEmpty())
+		{
+			std::unique_ptr<juce::AudioFormatReader> reader(formatManager.createReaderFor(output));
+
+			if (reader != nullptr && reader->lengthInSamples >= m_impulseLength)
+			{
+				juce::AudioBuffer<float> rendered(2, m_impulseLength);
+				reader->read(&rendered, 0, m_impulseLength, 0, true, true);
+
+				// The first sample reaching half the peak, so the FIR pre-ringing and the IIR tails do not count
+				const float peak = rendered.getMagnitude(0, 0, m_impulseLength);
+				const float* left = rendered.getReadPointer(0);
+				int sample = 0;
+
+				while (sample < m_impulseLength - 1 && std::abs(left[sample]) < 0.5f * peak)
+					++sample;
+
+				onset = (double)sample;
+			}
+		}
+
+		checks.push_back({ name, onset, 0.0, "samples" });
+	}
+
+	input.deleteFile();
+	output.deleteFile();
+}
+
+void Verification::checkStateLoading(std::vector<Check>& checks)
+{
+	const int nParameters = MultibandMSAudioProcessor::N_PARAMETERS;
+	const int nValues = nParameters + PresetBank::N_SLOTS * PresetBank::N_VALUES;
+
+	auto getParameter = [](MultibandMSAudioProcessor& processor, int index)
+	{
+		return processor.apvts.getParameter(MultibandMSAudioProcessor::paramsNames[(size_t)index]);
+	};
+
+	// Parameters, then the A and B snapshots, as the processor saves them
+	auto readState = [nValues](MultibandMSAudioProcessor& processor)
+	{
+		juce::MemoryBlock state;
+		processor.getStateInformation(state);
+
+		std::vector<float> values((size_t)nValues, 0.0f);
+		values.resize((size_t)juce::jmax(0, BinaryState::read(state.getData(), (int)state.getSize(), values.data(), nValues)));
+
+		return values;
+	};
+
+	auto difference = [](const std::vector<float>& a, const std::vector<float>& b)
+	{
+		if (a.size() != b.size())
+			return std::numeric_limits<double>::infinity();
+
+		double error = 0.0;
+		for (size_t index = 0; index < a.size(); ++index)
+			error = juce::jmax(error, std::abs((double)a[index] - (double)b[index]));
+
+		return error;
+	};
+
+	// Away from the defaults, with B stored from other knob values than A
+	MultibandMSAudioProcessor source;
+	for (int index = 0; index < nParameters; ++index)
+		getParameter(source, index)->setValueNotifyingHost(0.3f);
+
+	source.storeSnapshot(1);
+
+	juce::MemoryBlock state;
+	source.getStateInformation(state);
+	const auto expected = readState(source);
+
+	MultibandMSAudioProcessor loaded;
+	loaded.setStateInformation(state.getData(), (int)state.getSize());
+	// Parameter values pass the normalised range on the way in, which may round in the last bits
+	checks.push_back({ "Plugin state round trip", difference(readState(loaded), expected), 1.0e-3, "abs" });
+
+	// A state cut short anywhere is rejected as a whole, and leaves the loaded one as it was
+	double truncationError = 0.0;
+	for (int size = 0; size < (int)state.getSize(); ++size)
+	{
+		loaded.setStateInformation(state.getData(), size);
+		truncationError = juce::jmax(truncationError, difference(readState(loaded), expected));
+	}
+
+	checks.push_back({ "Plugin state cut short", truncationError, 1.0e-3, "abs" });
+
+	// Non-finite and out of range values, for parameters and snapshots alike, must end up within the ranges
+	const float corruptions[] = { std::numeric_limits<float>::quiet_NaN(), std::numeric_limits<float>::infinity(),
+	                              -std::numeric_limits<float>::infinity(), 1.0e30f, -1.0e30f };
+
+	std::vector<float> corrupted((size_t)nValues);
+	for (int index = 0; index < nValues; ++index)
+		corrupted[(size_t)index] = corruptions[index % 5];
+
+	juce::MemoryBlock damaged;
+	BinaryState::write(corrupted.data(), nValues, damaged);
+	loaded.setStateInformation(damaged.getData(), (int)damaged.getSize());
+
+	const auto values = readState(loaded);
+	int invalid = values.size() == (size_t)nValues ? 0 : nValues;
+
+	for (int index = 0; index < (int)values.size(); ++index)
+	{
+		const int parameter = index < nParameters ? index : (index - nParameters) % PresetBank::N_VALUES;
+		const auto range = getParameter(loaded, parameter)->getNormalisableRange().getRange();
+		const float value = values[(size_t)index];
+
+		if (!std::isfinite(value) || value < range.getStart() || value > range.getEnd())
+			++invalid;
+	}
+
+	checks.push_back({ "Plugin state with corrupted values", (double)invalid, 0.0, "invalid values" });
+}
+
+//==============================================================================
+void Verification::compareResponse(std::vector<Check>& checks, const juce::String& name, const std::vector<double>& impulse,
+                                   const std::function<std::complex<double>(double)>& reference, double magnitudeTolerance, double phaseTolerance)
+{
+	double magnitudeError = 0.0;
+	double phaseError = 0.0;
+
+	for (const double frequency : m_frequencies)
+	{
+		// Deep in a stop band the rounding floor dominates the relative error, and is far below audibility
+		const std::complex<double> expected = reference(frequency);
+		if (std::abs(expected) < STOP_BAND_LEVEL)
+			continue;
+
+		const std::complex<double> ratio = response(impulse, frequency) / expected;
+
+		magnitudeError = juce::jmax(magnitudeError, std::abs(20.0 * std::log10(std::abs(ratio))));
+		phaseError = juce::jmax(phaseError, std::abs(std::arg(ratio)) * 180.0 / pi);
+	}
+
+	checks.push_back({ name + " magnitude", magnitudeError, magnitudeTolerance, "dB" });
+	checks.push_back({ name + " phase", phaseError, phaseTolerance, "deg" });
+}
+
+double Verification::flatness(const std::vector<double>& impulse) const
+{
+	double error = 0.0;
+
+	for (const double frequency : m_frequencies)
+		error = juce::jmax(error, std::abs(20.0 * std::log10(std::abs(response(impulse, frequency)))));
+
+	return error;
+}
+
+std::complex<double> Verification::response(const std::vector<double>& impulse, double frequency) const
+{
+	// Direct DFT at one frequency, with the phasor advanced by multiplication
+	const std::complex<double> step = std::polar(1.0, -2.0 * pi * frequency / m_sampleRate);
+	std::complex<double> phasor(1.0, 0.0);
+	std::complex<double> sum(0.0, 0.0);
+
+	for (const double value : impulse)
+	{
+		sum += value * phasor;
+		phasor *= step;
+	}
+
+	return sum;
+}
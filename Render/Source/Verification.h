@@ -0,0 +1,73 @@
+/*
+  ==============================================================================
+
+    Numerical accuracy checks of the filters, crossover kernels and engine.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "../../Source/MultibandEngine.h"
+#include <complex>
+#include <functional>
+
+//==============================================================================
+// Golden references for the DSP, so optimizations can be checked against audible regressions:
+// - the scalar filters against the analytic responses of their bilinear transformed prototypes
+// - the stereo CrossoverTree kernels against a tree of the scalar filters, at 12, 24 and 48 dB
+// - every SimdKernel this CPU runs against the scalar one, as the engine dispatches them
+// - the bands mixed at width 1 summing to a flat magnitude, for CrossoverTree and the engine
+// - a sine coming out of a bypass exactly as if it had never been bypassed, with no step at either edge
+// - an impulse rendered to file landing on its input position, in every latency mode
+// - plugin state surviving a round trip, and truncated or corrupted states loading safely
+class Verification
+{
+public:
+	struct Check
+	{
+		juce::String name;
+		double error = 0.0;
+		double tolerance = 0.0;
+		const char* unit = "";
+
+		bool passed() const { return error <= tolerance; }
+	};
+
+	Verification(double sampleRate);
+
+	std::vector<Check> run();
+
+	static void print(const Check& check);
+
+private:
+	static constexpr double STOP_BAND_LEVEL = 1.0e-3; // -60 dB, responses below it are not compared
+
+	template <typename SampleType>
+	void checkFilterResponses(std::vector<Check>& checks);
+	template <int Order, typename SampleType>
+	void checkKernel(std::vector<Check>& checks);
+	template <int Order, typename SampleType>
+	void checkTreeReconstruction(std::vector<Check>& checks);
+	template <typename SampleType>
+	void checkKernelDispatch(std::vector<Check>& checks);
+	template <typename SampleType>
+	void checkEngineReconstruction(std::vector<Check>& checks);
+	void checkBypassResume(std::vector<Check>& checks);
+	void checkRenderAlignment(std::vector<Check>& checks);
+	void checkStateLoading(std::vector<Check>& checks);
+
+	// Largest magnitude (dB) and phase (degrees) deviation of impulse from reference over the test frequencies
+	void compareResponse(std::vector<Check>& checks, const juce::String& name, const std::vector<double>& impulse,
+	                     const std::function<std::complex<double>(double)>& reference, double magnitudeTolerance, double phaseTolerance);
+
+	// Largest deviation of the impulse response magnitude from 0 dB over the test frequencies
+	double flatness(const std::vector<double>& impulse) const;
+
+	std::complex<double> response(const std::vector<double>& impulse, double frequency) const;
+
+	double m_sampleRate;
+	int m_impulseLength;
+	std::vector<double> m_frequencies; // 1/3 octave from 20 Hz to 0.45 of the sample rate
+};
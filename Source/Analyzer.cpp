@@ -0,0 +1,294 @@
+/*
+  ==============================================================================
+
+    Spectrum and stereo field analyzer. The audio thread only feeds a lock-free
+    FIFO; analysis and drawing run on a worker thread, the editor blits frames.
+
+  ==============================================================================
+*/
+
+#include "Analyzer.h"
+#include "PluginEditor.h"
+
+//==============================================================================
+AnalyzerFifo::AnalyzerFifo() :
+	m_left(CAPACITY),
+	m_right(CAPACITY)
+{
+}
+
+int AnalyzerFifo::pull(float* left, float* right, int maxSamples)
+{
+	int start1, size1, start2, size2;
+	m_fifo.prepareToRead(maxSamples, start1, size1, start2, size2);
+
+	std::copy(m_left.begin() + start1, m_left.begin() + start1 + size1, left);
+	std::copy(m_right.begin() + start1, m_right.begin() + start1 + size1, right);
+	std::copy(m_left.begin() + start2, m_left.begin() + start2 + size2, left + size1);
+	std::copy(m_right.begin() + start2, m_right.begin() + start2 + size2, right + size1);
+
+	m_fifo.finishedRead(size1 + size2);
+	return size1 + size2;
+}
+
+//==============================================================================
+AnalyzerWorker::AnalyzerWorker(AnalyzerFifo& fifo) :
+	juce::Thread("MultibandMS analyzer"),
+	m_fifo(fifo),
+	m_historyLeft(FFT_SIZE, 0.0f),
+	m_historyRight(FFT_SIZE, 0.0f),
+	m_pullLeft(FFT_SIZE),
+	m_pullRight(FFT_SIZE),
+	m_fftData(2 * FFT_SIZE),
+	m_midSpectrum(N_BINS, FLOOR_DB),
+	m_sideSpectrum(N_BINS, FLOOR_DB)
+{
+	m_fifo.setActive(true);
+	startThread();
+}
+
+AnalyzerWorker::~AnalyzerWorker()
+{
+	m_fifo.setActive(false);
+	stopThread(1000);
+}
+
+void AnalyzerWorker::setFrameSize(int width, int height, float scale)
+{
+	m_width.store(width);
+	m_height.store(height);
+	m_scale.store(scale);
+}
+
+void AnalyzerWorker::run()
+{
+	while (!threadShouldExit())
+	{
+		int pulled = 0;
+		while (const int samples = m_fifo.pull(m_pullLeft.data(), m_pullRight.data(), FFT_SIZE))
+		{
+			for (int sample = 0; sample < samples; ++sample)
+			{
+				m_historyLeft[m_historyPosition] = m_pullLeft[sample];
+				m_historyRight[m_historyPosition] = m_pullRight[sample];
+				m_historyPosition = (m_historyPosition + 1) & (FFT_SIZE - 1);
+			}
+
+			pulled += samples;
+		}
+
+		// Frames only change with new audio, a stopped host costs nothing
+		if (pulled > 0)
+		{
+			m_fifo.readStatus(m_status);
+			analyse();
+
+			if (render(m_frames.getWriteSlot()))
+				m_frames.publish();
+		}
+
+		wait(1000 / FRAME_RATE);
+	}
+}
+
+void AnalyzerWorker::analyse()
+{
+	analyseChannel(1.0f, m_midSpectrum);
+	analyseChannel(-1.0f, m_sideSpectrum);
+}
+
+void AnalyzerWorker::analyseChannel(float sign, std::vector<float>& spectrum)
+{
+	for (int sample = 0; sample < FFT_SIZE; ++sample)
+	{
+		const int index = (m_historyPosition + sample) & (FFT_SIZE - 1);
+		m_fftData[sample] = 0.5f * (m_historyLeft[index] + sign * m_historyRight[index]);
+	}
+
+	m_window.multiplyWithWindowingTable(m_fftData.data(), (size_t)FFT_SIZE);
+	m_fft.performFrequencyOnlyForwardTransform(m_fftData.data());
+
+	// A full scale sine reads 0 dB through the Hann window, whose coherent gain is 1/2
+	const float normalise = 4.0f / (float)FFT_SIZE;
+
+	for (int bin = 0; bin < N_BINS; ++bin)
+	{
+		const float db = juce::Decibels::gainToDecibels(m_fftData[bin] * normalise, FLOOR_DB);
+		spectrum[bin] = juce::jmax(db, spectrum[bin] - FALL_DB);
+	}
+}
+
+bool AnalyzerWorker::render(juce::Image& image)
+{
+	const int width = m_width.load();
+	const int height = m_height.load();
+	const float scale = m_scale.load();
+
+	if (width <= 0 || height <= 0)
+		return false;
+
+	const int imageWidth = juce::roundToInt(width * scale);
+	const int imageHeight = juce::roundToInt(height * scale);
+
+	// The slot is reused frame after frame, reallocated only on resize
+	if (image.isNull() || image.getWidth() != imageWidth || image.getHeight() != imageHeight)
+		image = juce::Image(juce::Image::RGB, juce::jmax(1, imageWidth), juce::jmax(1, imageHeight), false);
+
+	juce::Graphics g(image);
+	g.addTransform(juce::AffineTransform::scale(scale));
+	g.fillAll(ZazzLookAndFeel::darkColour);
+
+	auto area = juce::Rectangle<float>((float)width, (float)height).reduced(4.0f);
+	drawGoniometer(g, area.removeFromLeft(area.getHeight()));
+	area.removeFromLeft(8.0f);
+	drawSpectrum(g, area);
+
+	return true;
+}
+
+void AnalyzerWorker::drawGoniometer(juce::Graphics& g, juce::Rectangle<float> area)
+{
+	const float radius = 0.5f * area.getWidth();
+	const float centreX = area.getCentreX();
+	const float centreY = area.getCentreY();
+	const float diagonal = radius * 0.70710678f;
+
+	// Mono is vertical, left and right on the diagonals
+	g.setColour(ZazzLookAndFeel::mediumColour);
+	g.drawLine(centreX, area.getY(), centreX, area.getBottom(), 1.0f);
+	g.drawLine(centreX - diagonal, centreY - diagonal, centreX + diagonal, centreY + diagonal, 1.0f);
+	g.drawLine(centreX - diagonal, centreY + diagonal, centreX + diagonal, centreY - diagonal, 1.0f);
+
+	juce::Path trace;
+	trace.preallocateSpace(3 * GONIOMETER_POINTS);
+
+	for (int point = 0; point < GONIOMETER_POINTS; ++point)
+	{
+		const int index = (m_historyPosition - GONIOMETER_POINTS + point) & (FFT_SIZE - 1);
+		const float mid = juce::jlimit(-1.0f, 1.0f, 0.5f * (m_historyLeft[index] + m_historyRight[index]));
+		const float side = juce::jlimit(-1.0f, 1.0f, 0.5f * (m_historyLeft[index] - m_historyRight[index]));
+		const float x = centreX + radius * side;
+		const float y = centreY - radius * mid;
+
+		if (point == 0)
+			trace.startNewSubPath(x, y);
+		else
+			trace.lineTo(x, y);
+	}
+
+	g.setColour(ZazzLookAndFeel::lightColour.withAlpha(0.7f));
+	g.strokePath(trace, juce::PathStrokeType(1.0f));
+}
+
+void AnalyzerWorker::drawSpectrum(juce::Graphics& g, juce::Rectangle<float> area)
+{
+	const double sampleRate = m_status.sampleRate;
+	if (sampleRate <= 0.0)
+		return;
+
+	const float logMin = std::log((float)MultibandMSAudioProcessor::FREQUENCY_MIN);
+	const float logRange = std::log((float)MultibandMSAudioProcessor::FREQUENCY_MAX) - logMin;
+	auto frequencyToX = [&](float frequency) { return area.getX() + area.getWidth() * (std::log(frequency) - logMin) / logRange; };
+
+	// Middle band shaded between the crossover frequencies the engine is at, which glide behind the knobs
+	const float lowMid = frequencyToX(juce::jmax(1.0f, m_status.frequencies[0]));
+	const float midHigh = frequencyToX(juce::jmax(1.0f, m_status.frequencies[1]));
+
+	g.setColour(ZazzLookAndFeel::mediumColour.withAlpha(0.35f));
+	g.fillRect(juce::Rectangle<float>(lowMid, area.getY(), juce::jmax(0.0f, midHigh - lowMid), area.getHeight()));
+
+	// Decade grid
+	g.setColour(ZazzLookAndFeel::mediumColour);
+	for (float frequency = 100.0f; frequency < (float)MultibandMSAudioProcessor::FREQUENCY_MAX; frequency *= 10.0f)
+		g.drawVerticalLine(juce::roundToInt(frequencyToX(frequency)), area.getY(), area.getBottom());
+
+	auto mid = makeSpectrumPath(m_midSpectrum, area, sampleRate);
+	auto side = makeSpectrumPath(m_sideSpectrum, area, sampleRate);
+
+	g.setColour(ZazzLookAndFeel::lightColour);
+	g.strokePath(mid, juce::PathStrokeType(1.5f));
+	g.setColour(juce::Colours::white.withAlpha(0.6f));
+	g.strokePath(side, juce::PathStrokeType(1.0f));
+
+	// Crossover markers
+	g.setColour(ZazzLookAndFeel::lightColour);
+	g.drawLine(lowMid, area.getY(), lowMid, area.getBottom(), 2.0f);
+	g.drawLine(midHigh, area.getY(), midHigh, area.getBottom(), 2.0f);
+}
+
+juce::Path AnalyzerWorker::makeSpectrumPath(const std::vector<float>& spectrum, juce::Rectangle<float> area, double sampleRate)
+{
+	const float binWidth = (float)(sampleRate / FFT_SIZE);
+	const float logMin = std::log((float)MultibandMSAudioProcessor::FREQUENCY_MIN);
+	const float logRange = std::log((float)MultibandMSAudioProcessor::FREQUENCY_MAX) - logMin;
+	const int columns = juce::jmax(1, (int)area.getWidth());
+
+	juce::Path path;
+	path.preallocateSpace(3 * (columns + 1));
+
+	// One point per pixel column: interpolated where bins are sparse, their maximum where dense
+	for (int column = 0; column <= columns; ++column)
+	{
+		const float start = std::exp(logMin + logRange * (float)column / (float)columns) / binWidth;
+		const float end = std::exp(logMin + logRange * (float)(column + 1) / (float)columns) / binWidth;
+		const int first = juce::jlimit(0, N_BINS - 2, (int)start);
+		const int last = juce::jlimit(first, N_BINS - 1, (int)end);
+
+		float db;
+		if (last - first < 2)
+		{
+			const float fraction = juce::jlimit(0.0f, 1.0f, start - (float)first);
+			db = spectrum[first] + fraction * (spectrum[first + 1] - spectrum[first]);
+		}
+		else
+		{
+			db = *std::max_element(spectrum.begin() + first, spectrum.begin() + last + 1);
+		}
+
+		const float x = area.getX() + area.getWidth() * (float)column / (float)columns;
+		const float y = area.getY() + area.getHeight() * juce::jlimit(0.0f, 1.0f, db / FLOOR_DB);
+
+		if (column == 0)
+			path.startNewSubPath(x, y);
+		else
+			path.lineTo(x, y);
+	}
+
+	return path;
+}
+
+//==============================================================================
+AnalyzerView::AnalyzerView(AnalyzerFifo& fifo) :
+	m_worker(fifo)
+{
+	setOpaque(true);
+	setInterceptsMouseClicks(false, false);
+}
+
+void AnalyzerView::update()
+{
+	if (m_worker.getFrames().acquire())
+		repaint();
+}
+
+void AnalyzerView::paint(juce::Graphics& g)
+{
+	const float scale = g.getInternalContext().getPhysicalPixelScaleFactor();
+	if (scale != m_scale)
+	{
+		m_scale = scale;
+		m_worker.setFrameSize(getWidth(), getHeight(), m_scale);
+	}
+
+	const auto& frame = m_worker.getFrames().getReadSlot();
+
+	if (frame.isNull())
+		g.fillAll(ZazzLookAndFeel::darkColour);
+	else
+		g.drawImage(frame, getLocalBounds().toFloat(), juce::RectanglePlacement::stretchToFit);
+}
+
+void AnalyzerView::resized()
+{
+	m_worker.setFrameSize(getWidth(), getHeight(), m_scale);
+}
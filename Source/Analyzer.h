@@ -0,0 +1,141 @@
+/*
+  ==============================================================================
+
+    Spectrum and stereo field analyzer. The audio thread only feeds a lock-free
+    FIFO; analysis and drawing run on a worker thread, the editor blits frames.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "SnapshotBridge.h"
+#include "ParameterSnapshot.h"
+
+//==============================================================================
+// The processing the samples come from, as the engine runs it
+struct AnalyzerStatus
+{
+	double sampleRate = 0.0;
+	float frequencies[ParameterSnapshot::N_BANDS - 1] = {}; // effective crossovers, gliding with the engine
+};
+
+//==============================================================================
+// Output samples from the audio thread to the analyzer worker. Nothing is pushed while no
+// analyzer is open, and samples that do not fit are dropped.
+class AnalyzerFifo
+{
+public:
+	static const int CAPACITY = 1 << 15;
+
+	AnalyzerFifo();
+
+	void setActive(bool active) { m_active.store(active, std::memory_order_relaxed); }
+
+	// Audio thread
+	template <typename SampleType>
+	void push(const SampleType* left, const SampleType* right, int samples, const AnalyzerStatus& status)
+	{
+		if (!m_active.load(std::memory_order_relaxed))
+			return;
+
+		m_status.publish(status);
+
+		int start1, size1, start2, size2;
+		m_fifo.prepareToWrite(samples, start1, size1, start2, size2);
+
+		std::copy(left, left + size1, m_left.begin() + start1);
+		std::copy(right, right + size1, m_right.begin() + start1);
+		std::copy(left + size1, left + size1 + size2, m_left.begin() + start2);
+		std::copy(right + size1, right + size1 + size2, m_right.begin() + start2);
+
+		m_fifo.finishedWrite(size1 + size2);
+	}
+
+	// Worker thread, returns the number of samples pulled
+	int pull(float* left, float* right, int maxSamples);
+
+	// Worker thread, false if no status came with the samples since the last call
+	bool readStatus(AnalyzerStatus& status) { return m_status.read(status); }
+
+private:
+	juce::AbstractFifo m_fifo{ CAPACITY };
+	std::vector<float> m_left;
+	std::vector<float> m_right;
+	std::atomic<bool> m_active{ false };
+	SnapshotBridge<AnalyzerStatus> m_status;
+};
+
+//==============================================================================
+// Mid and side spectra with the crossover bands on the right, goniometer on the left.
+// Frames are rendered at the view size and display scale the view last asked for.
+class AnalyzerWorker : private juce::Thread
+{
+public:
+	static const int FFT_ORDER = 11;
+	static const int FFT_SIZE = 1 << FFT_ORDER;
+	static const int N_BINS = FFT_SIZE / 2 + 1;
+	static const int FRAME_RATE = 30;
+	static const int GONIOMETER_POINTS = 512;
+	static constexpr float FLOOR_DB = -90.0f;
+	static constexpr float FALL_DB = 1.5f; // per frame
+
+	AnalyzerWorker(AnalyzerFifo& fifo);
+	~AnalyzerWorker() override;
+
+	// Message thread, size in logical pixels
+	void setFrameSize(int width, int height, float scale);
+
+	SnapshotBridge<juce::Image>& getFrames() { return m_frames; }
+
+private:
+	void run() override;
+
+	void analyse();
+	void analyseChannel(float sign, std::vector<float>& spectrum);
+	bool render(juce::Image& image);
+	void drawGoniometer(juce::Graphics& g, juce::Rectangle<float> area);
+	void drawSpectrum(juce::Graphics& g, juce::Rectangle<float> area);
+	juce::Path makeSpectrumPath(const std::vector<float>& spectrum, juce::Rectangle<float> area, double sampleRate);
+
+	AnalyzerFifo& m_fifo;
+	AnalyzerStatus m_status; // of the latest samples pulled
+
+	juce::dsp::FFT m_fft{ FFT_ORDER };
+	juce::dsp::WindowingFunction<float> m_window{ (size_t)FFT_SIZE, juce::dsp::WindowingFunction<float>::hann, false };
+
+	// Last FFT_SIZE output samples, oldest at m_historyPosition
+	std::vector<float> m_historyLeft;
+	std::vector<float> m_historyRight;
+	int m_historyPosition = 0;
+
+	std::vector<float> m_pullLeft;
+	std::vector<float> m_pullRight;
+	std::vector<float> m_fftData;
+	std::vector<float> m_midSpectrum;  // dB
+	std::vector<float> m_sideSpectrum; // dB
+
+	std::atomic<int> m_width{ 0 };
+	std::atomic<int> m_height{ 0 };
+	std::atomic<float> m_scale{ 1.0f };
+
+	SnapshotBridge<juce::Image> m_frames;
+};
+
+//==============================================================================
+class AnalyzerView : public juce::Component
+{
+public:
+	AnalyzerView(AnalyzerFifo& fifo);
+
+	// Message thread timer, repaints when the worker has a new frame
+	void update();
+
+	void paint(juce::Graphics& g) override;
+	void resized() override;
+
+private:
+	AnalyzerWorker m_worker;
+	float m_scale = 1.0f;
+};
@@ -0,0 +1,59 @@
+/*
+  ==============================================================================
+
+    Compact binary plugin state.
+
+  ==============================================================================
+*/
+
+#include "BinaryState.h"
+
+//==============================================================================
+void BinaryState::write(const float* values, int count, juce::MemoryBlock& destData)
+{
+	const juce::uint32 header[3] = { MAGIC, (juce::uint32)VERSION, (juce::uint32)count };
+
+	destData.setSize((size_t)(HEADER_SIZE + 4 * count));
+	auto* bytes = static_cast<char*>(destData.getData());
+
+	for (int word = 0; word < 3; ++word)
+	{
+		const juce::uint32 little = juce::ByteOrder::swapIfBigEndian(header[word]);
+		std::memcpy(bytes + 4 * word, &little, 4);
+	}
+
+	for (int index = 0; index < count; ++index)
+	{
+		juce::uint32 bits;
+		std::memcpy(&bits, values + index, 4);
+		bits = juce::ByteOrder::swapIfBigEndian(bits);
+		std::memcpy(bytes + HEADER_SIZE + 4 * index, &bits, 4);
+	}
+}
+
+int BinaryState::read(const void* data, int sizeInBytes, float* values, int maxCount)
+{
+	if (data == nullptr || sizeInBytes < HEADER_SIZE)
+		return -1;
+
+	const auto* bytes = static_cast<const char*>(data);
+
+	if (juce::ByteOrder::littleEndianInt(bytes) != MAGIC)
+		return -1;
+
+	const int version = (int)juce::ByteOrder::littleEndianInt(bytes + 4);
+	const juce::uint32 count = juce::ByteOrder::littleEndianInt(bytes + 8);
+
+	if (version < 1 || count > (juce::uint32)(sizeInBytes - HEADER_SIZE) / 4)
+		return -1;
+
+	const int available = juce::jmin((int)count, maxCount);
+
+	for (int index = 0; index < available; ++index)
+	{
+		const juce::uint32 bits = juce::ByteOrder::littleEndianInt(bytes + HEADER_SIZE + 4 * index);
+		std::memcpy(values + index, &bits, 4);
+	}
+
+	return available;
+}
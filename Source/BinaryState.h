@@ -0,0 +1,29 @@
+/*
+  ==============================================================================
+
+    Compact binary plugin state.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+//==============================================================================
+// Plain parameter values behind a little endian header of magic, version and value count.
+// Reading needs no DOM and no allocation. Versions only ever append values, so a state
+// from any version gives the values this one knows, and the rest keep their defaults.
+class BinaryState
+{
+public:
+	static const juce::uint32 MAGIC = 0x534d424d; // "MBMS"
+	static const int VERSION = 2; // 1: nine parameters, 2: Compare, Morph and the A/B snapshots
+	static const int HEADER_SIZE = 12;
+
+	static void write(const float* values, int count, juce::MemoryBlock& destData);
+
+	// Returns the number of values copied to values, at most maxCount, or -1 if data is
+	// not binary state, e.g. an XML state saved by earlier versions
+	static int read(const void* data, int sizeInBytes, float* values, int maxCount);
+};
@@ -0,0 +1,113 @@
+/*
+  ==============================================================================
+
+    Band split kernels for each instruction set, picked at runtime.
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+#include "CrossoverKernels.h"
+
+//==============================================================================
+template <typename SampleType>
+BandSplitter<SampleType>::BandSplitter()
+{
+}
+
+template <typename SampleType>
+BandSplitter<SampleType>::~BandSplitter()
+{
+}
+
+template class BandSplitter<float>;
+template class BandSplitter<double>;
+
+//==============================================================================
+bool isKernelAvailable(SimdKernel kernel)
+{
+	switch (kernel)
+	{
+		case SimdKernel::Scalar:
+			return true;
+
+	   #if MULTIBANDMS_SIMD_SSE2
+		case SimdKernel::Sse2:
+			return juce::SystemStats::hasSSE2();
+
+		// AVX2 rather than AVX, which would let AVX-only CPUs run code built with AVX2 code generation
+		case SimdKernel::Avx2:
+			return hasAvx2Kernel() && juce::SystemStats::hasAVX2();
+	   #endif
+
+	   #if MULTIBANDMS_SIMD_NEON
+		case SimdKernel::Neon:
+			return juce::SystemStats::hasNeon();
+	   #endif
+
+		default:
+			return false;
+	}
+}
+
+SimdKernel getBestKernel()
+{
+	for (const auto kernel : { SimdKernel::Avx2, SimdKernel::Sse2, SimdKernel::Neon })
+		if (isKernelAvailable(kernel))
+			return kernel;
+
+	return SimdKernel::Scalar;
+}
+
+SimdKernel resolveKernel(SimdKernel kernel)
+{
+	return kernel != SimdKernel::Auto && isKernelAvailable(kernel) ? kernel : getBestKernel();
+}
+
+const char* getKernelName(SimdKernel kernel)
+{
+	switch (kernel)
+	{
+		case SimdKernel::Scalar: return "scalar";
+		case SimdKernel::Sse2:   return "sse2";
+		case SimdKernel::Avx2:   return "avx2";
+		case SimdKernel::Neon:   return "neon";
+		default:                 return "auto";
+	}
+}
+
+SimdKernel findKernel(const char* name)
+{
+	for (const auto kernel : { SimdKernel::Scalar, SimdKernel::Sse2, SimdKernel::Avx2, SimdKernel::Neon })
+		if (juce::String(name).equalsIgnoreCase(getKernelName(kernel)))
+			return kernel;
+
+	return SimdKernel::Auto;
+}
+
+//==============================================================================
+template <typename SampleType>
+std::unique_ptr<BandSplitter<SampleType>> createBandSplitter(SimdKernel kernel)
+{
+	switch (resolveKernel(kernel))
+	{
+	   #if MULTIBANDMS_SIMD_SSE2
+		case SimdKernel::Avx2:
+			return std::unique_ptr<BandSplitter<SampleType>>(createAvx2BandSplitter<SampleType>());
+
+		case SimdKernel::Sse2:
+			return std::make_unique<BandSplitterKernel<SampleType, SimdKernel::Sse2>>();
+	   #endif
+
+	   #if MULTIBANDMS_SIMD_NEON
+		case SimdKernel::Neon:
+			return std::make_unique<BandSplitterKernel<SampleType, SimdKernel::Neon>>();
+	   #endif
+
+		default:
+			return std::make_unique<BandSplitterKernel<SampleType, SimdKernel::Scalar>>();
+	}
+}
+
+template std::unique_ptr<BandSplitter<float>> createBandSplitter<float>(SimdKernel);
+template std::unique_ptr<BandSplitter<double>> createBandSplitter<double>(SimdKernel);
@@ -0,0 +1,154 @@
+/*
+  ==============================================================================
+
+    Band split kernels for each instruction set, picked at runtime.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include "CrossoverTree.h"
+#include "ParameterSnapshot.h"
+#include <memory>
+
+//==============================================================================
+// Band split of one stereo pair or mono channel, with one crossover per slope (0, 1, 2 for 12,
+// 24 and 48 dB/oct) of which only the selected one runs. Behind a virtual interface, so the
+// engine holds whichever SimdKernel the CPU supports in one binary. Calls are per chunk, so
+// the dispatch costs next to nothing against the per sample work.
+template <typename SampleType>
+class BandSplitter
+{
+public:
+	static const int N_BANDS = ParameterSnapshot::N_BANDS;
+
+	BandSplitter();
+	virtual ~BandSplitter();
+
+	// Sets the rate of every slope
+	virtual void init(int sampleRate) = 0;
+
+	// Clears the states of one slope and sets its frequencies without a glide
+	virtual void reset(int slope, const float* frequencies) = 0;
+
+	// bands as for CrossoverTree::process. frequencies are the targets to glide to over the call, or
+	// nullptr to keep the current ones.
+	virtual void split(int slope, const SampleType* left, const SampleType* right, SampleType* const* bands, int samples, const float* frequencies) = 0;
+	virtual void splitMono(int slope, const SampleType* in, SampleType* const* bands, int samples, const float* frequencies) = 0;
+};
+
+// Defined with the SSE2 and scalar kernels, so the AVX2 build does not emit its own copies
+extern template class BandSplitter<float>;
+extern template class BandSplitter<double>;
+
+//==============================================================================
+template <typename SampleType, SimdKernel Kernel>
+class BandSplitterKernel : public BandSplitter<SampleType>
+{
+public:
+	static const int N_BANDS = BandSplitter<SampleType>::N_BANDS;
+
+	void init(int sampleRate) override
+	{
+		m_crossover12.init(sampleRate);
+		m_crossover24.init(sampleRate);
+		m_crossover48.init(sampleRate);
+	}
+
+	void reset(int slope, const float* frequencies) override
+	{
+		switch (slope)
+		{
+			case 1:  resetTree(m_crossover24, frequencies); break;
+			case 2:  resetTree(m_crossover48, frequencies); break;
+			default: resetTree(m_crossover12, frequencies); break;
+		}
+	}
+
+	void split(int slope, const SampleType* left, const SampleType* right, SampleType* const* bands, int samples, const float* frequencies) override
+	{
+		switch (slope)
+		{
+			case 1:  splitTree(m_crossover24, left, right, bands, samples, frequencies); break;
+			case 2:  splitTree(m_crossover48, left, right, bands, samples, frequencies); break;
+			default: splitTree(m_crossover12, left, right, bands, samples, frequencies); break;
+		}
+	}
+
+	void splitMono(int slope, const SampleType* in, SampleType* const* bands, int samples, const float* frequencies) override
+	{
+		switch (slope)
+		{
+			case 1:  splitTreeMono(m_crossover24, in, bands, samples, frequencies); break;
+			case 2:  splitTreeMono(m_crossover48, in, bands, samples, frequencies); break;
+			default: splitTreeMono(m_crossover12, in, bands, samples, frequencies); break;
+		}
+	}
+
+private:
+	template <class Tree>
+	static void resetTree(Tree& crossover, const float* frequencies)
+	{
+		crossover.reset();
+		crossover.setFrequencies(frequencies);
+	}
+
+	template <class Tree>
+	static void splitTree(Tree& crossover, const SampleType* left, const SampleType* right, SampleType* const* bands, int samples, const float* frequencies)
+	{
+		if (frequencies != nullptr)
+		{
+			crossover.setTargetFrequencies(frequencies, samples);
+			crossover.template process<true>(left, right, bands, samples);
+			crossover.endRamp();
+		}
+		else
+		{
+			crossover.template process<false>(left, right, bands, samples);
+		}
+	}
+
+	template <class Tree>
+	static void splitTreeMono(Tree& crossover, const SampleType* in, SampleType* const* bands, int samples, const float* frequencies)
+	{
+		if (frequencies != nullptr)
+		{
+			crossover.setTargetFrequencies(frequencies, samples);
+			crossover.template processMono<true>(in, bands, samples);
+			crossover.endRamp();
+		}
+		else
+		{
+			crossover.template processMono<false>(in, bands, samples);
+		}
+	}
+
+	CrossoverTree<N_BANDS, 2, SampleType, Kernel> m_crossover12;
+	CrossoverTree<N_BANDS, 4, SampleType, Kernel> m_crossover24;
+	CrossoverTree<N_BANDS, 8, SampleType, Kernel> m_crossover48;
+};
+
+//==============================================================================
+// True if the kernel is built into this binary and the CPU supports it. Scalar always is.
+bool isKernelAvailable(SimdKernel kernel);
+
+// The fastest available kernel: AVX2, then SSE2 on x86, NEON on ARM, scalar otherwise
+SimdKernel getBestKernel();
+
+// The kernel createBandSplitter builds for a request: Auto and unavailable ones become getBestKernel()
+SimdKernel resolveKernel(SimdKernel kernel);
+
+const char* getKernelName(SimdKernel kernel);
+
+// Kernel for a name of getKernelName, case insensitive, or Auto if there is none
+SimdKernel findKernel(const char* name);
+
+template <typename SampleType>
+std::unique_ptr<BandSplitter<SampleType>> createBandSplitter(SimdKernel kernel);
+
+// In CrossoverKernelsAvx2.cpp, the only file built with AVX2 code generation. nullptr, and
+// hasAvx2Kernel false, where the compiler was not set up for it.
+template <typename SampleType>
+BandSplitter<SampleType>* createAvx2BandSplitter();
+bool hasAvx2Kernel();
@@ -0,0 +1,45 @@
+/*
+  ==============================================================================
+
+    The AVX2 band split kernel.
+
+  ==============================================================================
+*/
+
+// Built with AVX2 code generation (the "avx2" compiler flag scheme of the projects), so anything
+// compiled here runs only on AVX2 CPUs. Everything this file instantiates must therefore be
+// specific to the AVX2 vector types: shared helpers are defined out of line elsewhere, and
+// JuceHeader.h stays out, or the linker could pick an AVX2 copy of an inline function for all.
+#include "CrossoverKernels.h"
+
+//==============================================================================
+#if MULTIBANDMS_SIMD_AVX2
+
+template <typename SampleType>
+BandSplitter<SampleType>* createAvx2BandSplitter()
+{
+	return new BandSplitterKernel<SampleType, SimdKernel::Avx2>();
+}
+
+bool hasAvx2Kernel()
+{
+	return true;
+}
+
+#else
+
+template <typename SampleType>
+BandSplitter<SampleType>* createAvx2BandSplitter()
+{
+	return nullptr;
+}
+
+bool hasAvx2Kernel()
+{
+	return false;
+}
+
+#endif
+
+template BandSplitter<float>* createAvx2BandSplitter<float>();
+template BandSplitter<double>* createAvx2BandSplitter<double>();
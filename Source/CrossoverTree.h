@@ -0,0 +1,187 @@
+/*
+  ==============================================================================
+
+    Stereo crossover splitting a signal into a compile-time number of bands.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include "Filters.h"
+
+//==============================================================================
+// Crossover and matching phase compensation for each Linkwitz-Riley order
+template <int Order, typename SampleType, SimdKernel Kernel>
+struct LinkwitzRileyTraits;
+
+template <typename SampleType, SimdKernel Kernel>
+struct LinkwitzRileyTraits<2, SampleType, Kernel>
+{
+	using Crossover = LinkwitzRileySecondOrderStereo<SampleType, Kernel>;
+	using AllPass = FirstOrderAllPassStereo<SampleType, Kernel>;
+};
+
+template <typename SampleType, SimdKernel Kernel>
+struct LinkwitzRileyTraits<4, SampleType, Kernel>
+{
+	using Crossover = LinkwitzRileyCascadeStereo<4, SampleType, Kernel>;
+	using AllPass = SecondOrderAllPassStereo<4, SampleType, Kernel>;
+};
+
+template <typename SampleType, SimdKernel Kernel>
+struct LinkwitzRileyTraits<8, SampleType, Kernel>
+{
+	using Crossover = LinkwitzRileyCascadeStereo<8, SampleType, Kernel>;
+	using AllPass = SecondOrderAllPassStereo<8, SampleType, Kernel>;
+};
+
+//==============================================================================
+// Cascade of Linkwitz-Riley crossovers of the given Order (2, 4 or 8, i.e. 12, 24 or
+// 48 dB/oct). Band k is the LP output of crossover k, phase compensated by all-passes
+// at every crossover above k + 1, so the bands always sum to an all-pass. Band count
+// and order are template parameters, so every loop below has a constant trip count
+// and is unrolled by the compiler. SampleType is float or double, Kernel the instruction
+// set the filters are built for.
+template <int NumBands, int Order = 2, typename SampleType = float, SimdKernel Kernel = NATIVE_KERNEL>
+class CrossoverTree
+{
+public:
+	static_assert(NumBands >= 2 && NumBands <= 8, "CrossoverTree supports 2 to 8 bands");
+
+	using Crossover = typename LinkwitzRileyTraits<Order, SampleType, Kernel>::Crossover;
+	using AllPass = typename LinkwitzRileyTraits<Order, SampleType, Kernel>::AllPass;
+	using Vector = typename Vector4<SampleType, Kernel>::Type;
+
+	static const int N_BANDS = NumBands;
+	static const int N_CROSSOVERS = NumBands - 1;
+	static const int N_ALL_PASS = (NumBands - 2) * (NumBands - 1) / 2;
+
+	void init(int sampleRate)
+	{
+		for (auto& crossover : m_crossover)
+			crossover.init(sampleRate);
+
+		for (auto& allPass : m_allPass)
+			allPass.init(sampleRate);
+	}
+
+	// frequencies holds N_CROSSOVERS ascending crossover frequencies
+	void setFrequencies(const float* frequencies)
+	{
+		for (int crossover = 0; crossover < N_CROSSOVERS; ++crossover)
+			m_crossover[crossover].setFrequency((SampleType)frequencies[crossover]);
+
+		int allPass = 0;
+		for (int band = 0; band < N_CROSSOVERS; ++band)
+			for (int crossover = band + 1; crossover < N_CROSSOVERS; ++crossover)
+				m_allPass[allPass++].setFrequency((SampleType)frequencies[crossover]);
+	}
+
+	// Linear coefficient ramp towards frequencies over the next rampSamples samples of process<true>
+	void setTargetFrequencies(const float* frequencies, int rampSamples)
+	{
+		for (int crossover = 0; crossover < N_CROSSOVERS; ++crossover)
+			m_crossover[crossover].setTargetFrequency((SampleType)frequencies[crossover], rampSamples);
+
+		int allPass = 0;
+		for (int band = 0; band < N_CROSSOVERS; ++band)
+			for (int crossover = band + 1; crossover < N_CROSSOVERS; ++crossover)
+				m_allPass[allPass++].setTargetFrequency((SampleType)frequencies[crossover], rampSamples);
+	}
+
+	void endRamp()
+	{
+		for (auto& crossover : m_crossover)
+			crossover.endRamp();
+
+		for (auto& allPass : m_allPass)
+			allPass.endRamp();
+	}
+
+	// Clears all filter states
+	void reset()
+	{
+		for (auto& crossover : m_crossover)
+			crossover.reset();
+
+		for (auto& allPass : m_allPass)
+			allPass.reset();
+	}
+
+	// bands[2 * k] and bands[2 * k + 1] receive left and right of band k
+	template <bool ramp>
+	void process(const SampleType* left, const SampleType* right, SampleType* const* bands, int samples)
+	{
+		split<ramp, false>(left, right, bands, samples);
+	}
+
+	// Mono kernel, bands[2 * k] receives band k and bands[2 * k + 1] is left untouched
+	template <bool ramp>
+	void processMono(const SampleType* in, SampleType* const* bands, int samples)
+	{
+		split<ramp, true>(in, in, bands, samples);
+	}
+
+private:
+	template <bool ramp, bool mono>
+	void split(const SampleType* left, const SampleType* right, SampleType* const* bands, int samples)
+	{
+		SampleType* out[2 * NumBands];
+		for (int channel = 0; channel < 2 * NumBands; ++channel)
+			out[channel] = bands[channel];
+
+		// Work on local copies, so filter states and coefficients can stay in registers for the
+		// whole block instead of being written back to the members every sample
+		Crossover crossovers[N_CROSSOVERS];
+		AllPass allPasses[N_ALL_PASS > 0 ? N_ALL_PASS : 1];
+		std::copy(std::begin(m_crossover), std::end(m_crossover), std::begin(crossovers));
+		std::copy(std::begin(m_allPass), std::end(m_allPass), std::begin(allPasses));
+
+		alignas(32) SampleType lanes[4];
+
+		for (int sample = 0; sample < samples; ++sample)
+		{
+			const SampleType inLeft = left[sample];
+			const SampleType inRight = mono ? inLeft : right[sample];
+
+			Vector rest = mono ? Vector::broadcast(inLeft) : Vector::set(inLeft, inRight, inLeft, inRight);
+			int allPass = 0;
+
+			for (int crossover = 0; crossover < N_CROSSOVERS; ++crossover)
+			{
+				// Lanes are [LP left, LP right, HP left, HP right]
+				const Vector split = ramp ? crossovers[crossover].processRamped(rest) : crossovers[crossover].process(rest);
+
+				Vector band = split;
+				for (int compensation = crossover + 1; compensation < N_CROSSOVERS; ++compensation, ++allPass)
+					band = ramp ? allPasses[allPass].processRamped(band) : allPasses[allPass].process(band);
+
+				band.store(lanes);
+				out[2 * crossover][sample] = lanes[0];
+				if (!mono)
+					out[2 * crossover + 1][sample] = lanes[1];
+
+				rest = split.upperHalves();
+			}
+
+			// Highest band is the HP output of the last crossover, which needs no compensation
+			out[2 * NumBands - 2][sample] = lanes[2];
+			if (!mono)
+				out[2 * NumBands - 1][sample] = lanes[3];
+		}
+
+		// Once per block is enough to keep decaying tails out of the subnormal range
+		for (auto& crossover : crossovers)
+			crossover.flushDenormals();
+
+		for (int allPass = 0; allPass < N_ALL_PASS; ++allPass)
+			allPasses[allPass].flushDenormals();
+
+		std::copy(std::begin(crossovers), std::end(crossovers), std::begin(m_crossover));
+		std::copy(std::begin(allPasses), std::end(allPasses), std::begin(m_allPass));
+	}
+
+	Crossover m_crossover[N_CROSSOVERS];
+	AllPass m_allPass[N_ALL_PASS > 0 ? N_ALL_PASS : 1];
+};
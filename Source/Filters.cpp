@@ -0,0 +1,223 @@
+/*
+  ==============================================================================
+
+    Filter building blocks of the crossover.
+
+  ==============================================================================
+*/
+
+#include "Filters.h"
+#include <cmath>
+
+//==============================================================================
+template <typename SampleType>
+FirstOrderAllPass<SampleType>::FirstOrderAllPass()
+{
+}
+
+template <typename SampleType>
+void FirstOrderAllPass<SampleType>::init(int sampleRate)
+{
+	m_SampleRate = sampleRate;
+}
+
+template <typename SampleType>
+void FirstOrderAllPass<SampleType>::setFrequency(SampleType frequency)
+{
+	if (m_SampleRate == 0)
+	{
+		return;
+	}
+
+	const SampleType pi = (SampleType)3.141592653589793;
+
+	const SampleType tmp = std::tan(pi * frequency / m_SampleRate);
+	m_a1 = (tmp - 1) / (tmp + 1);
+}
+
+template <typename SampleType>
+void FirstOrderAllPass<SampleType>::setCoef(SampleType coef)
+{
+	m_a1 = coef;
+}
+
+template <typename SampleType>
+void FirstOrderAllPass<SampleType>::setTargetFrequency(SampleType frequency, int rampSamples)
+{
+	const SampleType a1 = m_a1;
+	setFrequency(frequency);
+
+	m_a1Target = m_a1;
+	m_a1Step = (m_a1Target - a1) / (SampleType)rampSamples;
+	m_a1 = a1;
+}
+
+template <typename SampleType>
+void FirstOrderAllPass<SampleType>::endRamp()
+{
+	m_a1 = m_a1Target;
+	m_a1Step = 0;
+}
+
+template <typename SampleType>
+SampleType FirstOrderAllPass<SampleType>::process(SampleType in)
+{
+	const SampleType tmp = m_a1 * in + m_d;
+	m_d = in - m_a1 * tmp;
+	return tmp;
+}
+
+template <typename SampleType>
+void FirstOrderAllPass<SampleType>::flushDenormals()
+{
+	flushDenormal(m_d);
+}
+
+//==============================================================================
+template <typename SampleType>
+SecondOrderAllPass<SampleType>::SecondOrderAllPass()
+{
+}
+
+template <typename SampleType>
+void SecondOrderAllPass<SampleType>::init(int sampleRate)
+{
+	m_SampleRate = sampleRate;
+}
+
+template <typename SampleType>
+void SecondOrderAllPass<SampleType>::setFrequency(SampleType frequency, SampleType Q)
+{
+	if (m_SampleRate == 0)
+	{
+		return;
+	}
+
+	const SampleType pi = (SampleType)3.141592653589793;
+
+	const SampleType w = 2 * pi * frequency / m_SampleRate;
+	const SampleType cosw = std::cos(w);
+	const SampleType alpha = std::sin(w) / (2 * Q);
+
+	const SampleType a2 = 1 + alpha;
+
+	m_a0 = (1 - alpha) / a2;
+	m_a1 = (-2 * cosw) / a2;
+}
+
+template <typename SampleType>
+SampleType SecondOrderAllPass<SampleType>::process(SampleType in)
+{
+	const SampleType y0 = m_a0 * (in - m_y2) + m_a1 * (m_x1 - m_y1) + m_x2;
+
+	m_x2 = m_x1;
+	m_x1 = in;
+	m_y2 = m_y1;
+	m_y1 = y0;
+
+	return y0;
+}
+
+template <typename SampleType>
+void SecondOrderAllPass<SampleType>::flushDenormals()
+{
+	flushDenormal(m_x1);
+	flushDenormal(m_x2);
+	flushDenormal(m_y1);
+	flushDenormal(m_y2);
+}
+
+//==============================================================================
+template <typename SampleType>
+LinkwitzRileySecondOrder<SampleType>::LinkwitzRileySecondOrder()
+{
+}
+
+template <typename SampleType>
+void LinkwitzRileySecondOrder<SampleType>::init(int sampleRate)
+{
+	m_SampleRate = sampleRate;
+}
+
+template <typename SampleType>
+void LinkwitzRileySecondOrder<SampleType>::setFrequency(SampleType frequency, SampleType Q)
+{
+	if (m_SampleRate == 0)
+	{
+		return;
+	}
+
+	const SampleType pi = (SampleType)3.141592653589793;
+
+	const SampleType fpi = pi * frequency;
+	const SampleType wc = 2 * fpi;
+	const SampleType wc2 = wc * wc;
+	const SampleType wc22 = 2 * wc2;
+	const SampleType k = wc / std::tan(fpi / m_SampleRate);
+	const SampleType k2 = k * k;
+	const SampleType k22 = 2 * k2;
+	const SampleType wck2 = wc * k / Q;
+	const SampleType tmpk = k2 + wc2 + wck2;
+	
+	m_b1 = (-k22 + wc22) / tmpk;
+	m_b2 = (-wck2 + k2 + wc2) / tmpk;
+	
+	//---------------
+	// low-pass
+	//---------------
+	m_a0_lp = wc2 / tmpk;
+	m_a1_lp = wc22 / tmpk;
+	m_a2_lp = wc2 / tmpk;
+	
+	//----------------
+	// high-pass
+	//----------------
+	m_a0_hp = k2 / tmpk;
+	m_a1_hp = -k22 / tmpk;
+	m_a2_hp = k2 / tmpk;	
+}
+
+template <typename SampleType>
+SampleType LinkwitzRileySecondOrder<SampleType>::processLP(SampleType in)
+{
+	const SampleType y0 = m_a0_lp * in + m_x0_lp;
+	m_x0_lp = m_a1_lp * in - m_b1 * y0 + m_x1_lp;
+	m_x1_lp = m_a2_lp * in - m_b2 * y0;
+
+	return y0;
+}
+
+template <typename SampleType>
+SampleType LinkwitzRileySecondOrder<SampleType>::processHP(SampleType in)
+{
+	const SampleType y0 = m_a0_hp * in + m_x0_hp;
+	m_x0_hp = m_a1_hp * in - m_b1 * y0 + m_x1_hp;
+	m_x1_hp = m_a2_hp * in - m_b2 * y0;
+
+	return -y0;
+}
+
+template <typename SampleType>
+void LinkwitzRileySecondOrder<SampleType>::flushDenormals()
+{
+	flushDenormal(m_x0_lp);
+	flushDenormal(m_x1_lp);
+	flushDenormal(m_x0_hp);
+	flushDenormal(m_x1_hp);
+}
+
+//==============================================================================
+double butterworthQ(int order, int section)
+{
+	const double pi = 3.141592653589793;
+	return 1.0 / (2.0 * std::cos(pi * (double)(2 * section + 1) / (double)(2 * order)));
+}
+
+//==============================================================================
+// The processor runs in single or double precision, as the host asks
+template class FirstOrderAllPass<float>;
+template class FirstOrderAllPass<double>;
+template class SecondOrderAllPass<float>;
+template class SecondOrderAllPass<double>;
+template class LinkwitzRileySecondOrder<float>;
+template class LinkwitzRileySecondOrder<double>;
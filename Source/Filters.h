@@ -0,0 +1,549 @@
+/*
+  ==============================================================================
+
+    Filter building blocks of the crossover.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include "SimdDouble4.h"
+#include <algorithm>
+#include <cmath>
+#include <iterator>
+
+//==============================================================================
+// Filter states decaying into the subnormal range cost many times a normal operation on x86
+// unless FTZ/DAZ is set, and the states of a stopped signal get there within a few thousand
+// samples. States below DENORMAL_THRESHOLD, around -300 dB, are flushed to zero once per
+// block, so tails stay cheap also where the host does not set FTZ/DAZ.
+static constexpr double DENORMAL_THRESHOLD = 1.0e-15;
+
+template <typename SampleType>
+inline void flushDenormal(SampleType& state)
+{
+	if (std::abs(state) < (SampleType)DENORMAL_THRESHOLD)
+		state = 0;
+}
+
+// Tests the lanes itself rather than through flushDenormal or std::abs, so a kernel built for AVX2
+// shares no function with the others
+template <typename SampleType, class Vector>
+inline void flushDenormals(Vector& state)
+{
+	alignas(32) SampleType lanes[4];
+	state.store(lanes);
+
+	for (auto& lane : lanes)
+		if (lane < (SampleType)DENORMAL_THRESHOLD && lane > -(SampleType)DENORMAL_THRESHOLD)
+			lane = 0;
+
+	state = Vector::load(lanes);
+}
+
+//==============================================================================
+// The filters are templated on SampleType, float or double. The stereo kernels run on
+// Float4 or Double4 through Vector4<SampleType, Kernel>, one instance per SimdKernel.
+template <typename SampleType>
+class FirstOrderAllPass
+{
+public:
+	FirstOrderAllPass();
+
+	void init(int sampleRate);
+	void setFrequency(SampleType frequency);
+	void setCoef(SampleType coef);
+	SampleType process(SampleType in);
+
+	// Linear coefficient ramp towards frequency over the next rampSamples calls of processRamped
+	void setTargetFrequency(SampleType frequency, int rampSamples);
+	void endRamp();
+
+	// Zeroes states below DENORMAL_THRESHOLD, once per block
+	void flushDenormals();
+
+	inline SampleType processRamped(SampleType in)
+	{
+		m_a1 += m_a1Step;
+		return process(in);
+	}
+
+protected:
+	SampleType m_SampleRate;
+	SampleType m_a1 = -1; // all pass filter coeficient
+	SampleType m_d = 0;   // history d = x[n-1] - a1y[n-1]
+
+	SampleType m_a1Target = -1;
+	SampleType m_a1Step = 0;
+};
+
+//==============================================================================
+template <typename SampleType>
+class SecondOrderAllPass
+{
+public:
+	SecondOrderAllPass();
+
+	void init(int sampleRate);
+	void setFrequency(SampleType frequency, SampleType Q);
+	SampleType process(SampleType in);
+	void flushDenormals();
+
+protected:
+	SampleType m_SampleRate;
+
+	SampleType m_x2 = 0;
+	SampleType m_x1 = 0;
+	SampleType m_y2 = 0;
+	SampleType m_y1 = 0;
+
+	SampleType m_a0 = 0;
+	SampleType m_a1 = 0;
+};
+
+//==============================================================================
+template <typename SampleType>
+class LinkwitzRileySecondOrder
+{
+public:
+	LinkwitzRileySecondOrder();
+
+	void init(int sampleRate);
+
+	// Q of 0.5 gives the Linkwitz-Riley section, other values give the sections of higher order cascades
+	void setFrequency(SampleType frequency, SampleType Q = 0.5);
+	SampleType processLP(SampleType in);
+	SampleType processHP(SampleType in);
+	void flushDenormals();
+
+protected:
+	SampleType m_SampleRate;
+	
+	SampleType m_b1 = 0;
+	SampleType m_b2 = 0;
+
+	SampleType m_a0_lp = 0;
+	SampleType m_a1_lp = 0;
+	SampleType m_a2_lp = 0;
+
+	SampleType m_a0_hp = 0;
+	SampleType m_a1_hp = 0;
+	SampleType m_a2_hp = 0;
+
+	SampleType m_x1_lp = 0;
+	SampleType m_x0_lp = 0;
+
+	SampleType m_x1_hp = 0;
+	SampleType m_x0_hp = 0;
+};
+
+//==============================================================================
+// Left and right LP and HP paths of one crossover point in a single vector.
+// Lanes are [LP left, LP right, HP left, HP right]. The HP sign inversion of
+// processHP is folded into the HP numerator coefficients.
+template <typename SampleType, SimdKernel Kernel = NATIVE_KERNEL>
+class LinkwitzRileySecondOrderStereo : protected LinkwitzRileySecondOrder<SampleType>
+{
+public:
+	using Vector = typename Vector4<SampleType, Kernel>::Type;
+
+	using LinkwitzRileySecondOrder<SampleType>::init;
+
+	void setFrequency(SampleType frequency)
+	{
+		LinkwitzRileySecondOrder<SampleType>::setFrequency(frequency);
+
+		m_coefs.a0 = Vector::set(this->m_a0_lp, this->m_a0_lp, -this->m_a0_hp, -this->m_a0_hp);
+		m_coefs.a1 = Vector::set(this->m_a1_lp, this->m_a1_lp, -this->m_a1_hp, -this->m_a1_hp);
+		m_coefs.a2 = Vector::set(this->m_a2_lp, this->m_a2_lp, -this->m_a2_hp, -this->m_a2_hp);
+		m_coefs.b1 = Vector::broadcast(this->m_b1);
+		m_coefs.b2 = Vector::broadcast(this->m_b2);
+	}
+
+	// Linear coefficient ramp towards frequency over the next rampSamples calls of processRamped
+	void setTargetFrequency(SampleType frequency, int rampSamples)
+	{
+		const Coefficients current = m_coefs;
+		setFrequency(frequency);
+
+		m_target = m_coefs;
+		m_coefs = current;
+
+		const Vector scale = Vector::broadcast((SampleType)1 / (SampleType)rampSamples);
+		m_step.a0 = (m_target.a0 - current.a0) * scale;
+		m_step.a1 = (m_target.a1 - current.a1) * scale;
+		m_step.a2 = (m_target.a2 - current.a2) * scale;
+		m_step.b1 = (m_target.b1 - current.b1) * scale;
+		m_step.b2 = (m_target.b2 - current.b2) * scale;
+	}
+
+	void endRamp()
+	{
+		m_coefs = m_target;
+	}
+
+	void reset()
+	{
+		m_x0 = Vector::broadcast(0);
+		m_x1 = Vector::broadcast(0);
+	}
+
+	void flushDenormals()
+	{
+		::flushDenormals<SampleType>(m_x0);
+		::flushDenormals<SampleType>(m_x1);
+	}
+
+	inline Vector process(Vector in)
+	{
+		const Vector y0 = m_coefs.a0 * in + m_x0;
+		m_x0 = m_coefs.a1 * in - m_coefs.b1 * y0 + m_x1;
+		m_x1 = m_coefs.a2 * in - m_coefs.b2 * y0;
+
+		return y0;
+	}
+
+	inline Vector processRamped(Vector in)
+	{
+		m_coefs.a0 = m_coefs.a0 + m_step.a0;
+		m_coefs.a1 = m_coefs.a1 + m_step.a1;
+		m_coefs.a2 = m_coefs.a2 + m_step.a2;
+		m_coefs.b1 = m_coefs.b1 + m_step.b1;
+		m_coefs.b2 = m_coefs.b2 + m_step.b2;
+
+		return process(in);
+	}
+
+protected:
+	struct Coefficients
+	{
+		Vector a0 = Vector::broadcast(0);
+		Vector a1 = Vector::broadcast(0);
+		Vector a2 = Vector::broadcast(0);
+		Vector b1 = Vector::broadcast(0);
+		Vector b2 = Vector::broadcast(0);
+	};
+
+	Coefficients m_coefs;
+	Coefficients m_target;
+	Coefficients m_step;
+
+	Vector m_x0 = Vector::broadcast(0);
+	Vector m_x1 = Vector::broadcast(0);
+};
+
+//==============================================================================
+// FirstOrderAllPass on a vector. Left and right are lanes 0 and 1; lanes 2 and 3 are
+// filtered as well but ignored, so crossover outputs can be fed in without a shuffle.
+template <typename SampleType, SimdKernel Kernel = NATIVE_KERNEL>
+class FirstOrderAllPassStereo : protected FirstOrderAllPass<SampleType>
+{
+public:
+	using Vector = typename Vector4<SampleType, Kernel>::Type;
+
+	using FirstOrderAllPass<SampleType>::init;
+
+	void setFrequency(SampleType frequency)
+	{
+		FirstOrderAllPass<SampleType>::setFrequency(frequency);
+		m_coef = Vector::broadcast(this->m_a1);
+		m_coefTarget = m_coef;
+	}
+
+	// Linear coefficient ramp towards frequency over the next rampSamples calls of processRamped
+	void setTargetFrequency(SampleType frequency, int rampSamples)
+	{
+		FirstOrderAllPass<SampleType>::setFrequency(frequency);
+
+		m_coefTarget = Vector::broadcast(this->m_a1);
+		m_coefStep = (m_coefTarget - m_coef) * Vector::broadcast((SampleType)1 / (SampleType)rampSamples);
+	}
+
+	void endRamp()
+	{
+		m_coef = m_coefTarget;
+	}
+
+	void reset()
+	{
+		m_state = Vector::broadcast(0);
+	}
+
+	void flushDenormals()
+	{
+		::flushDenormals<SampleType>(m_state);
+	}
+
+	inline Vector process(Vector in)
+	{
+		const Vector tmp = m_coef * in + m_state;
+		m_state = in - m_coef * tmp;
+		return tmp;
+	}
+
+	inline Vector processRamped(Vector in)
+	{
+		m_coef = m_coef + m_coefStep;
+		return process(in);
+	}
+
+protected:
+	Vector m_coef = Vector::broadcast(-1);
+	Vector m_coefTarget = Vector::broadcast(-1);
+	Vector m_coefStep = Vector::broadcast(0);
+	Vector m_state = Vector::broadcast(0);
+};
+
+//==============================================================================
+// Q of section 0 <= section < order / 2 of a Butterworth filter of even order
+double butterworthQ(int order, int section);
+
+//==============================================================================
+// Linkwitz-Riley crossover of Order 4 or 8, a Butterworth filter of Order / 2 squared,
+// built from Order / 2 cascaded LinkwitzRileySecondOrder sections. Lanes are
+// [LP left, LP right, HP left, HP right], as in LinkwitzRileySecondOrderStereo. All
+// sections run back to back in one call, so their states never leave registers.
+template <int Order, typename SampleType, SimdKernel Kernel = NATIVE_KERNEL>
+class LinkwitzRileyCascadeStereo : protected LinkwitzRileySecondOrder<SampleType>
+{
+public:
+	static_assert(Order == 4 || Order == 8, "LinkwitzRileyCascadeStereo supports orders 4 and 8");
+
+	using Vector = typename Vector4<SampleType, Kernel>::Type;
+
+	static const int N_SECTIONS = Order / 2;
+
+	using LinkwitzRileySecondOrder<SampleType>::init;
+
+	void setFrequency(SampleType frequency)
+	{
+		const int butterworthOrder = Order / 2;
+
+		for (int section = 0; section < N_SECTIONS; ++section)
+		{
+			LinkwitzRileySecondOrder<SampleType>::setFrequency(frequency, (SampleType)butterworthQ(butterworthOrder, section % (butterworthOrder / 2)));
+
+			auto& coefs = m_coefs[section];
+			coefs.a0 = Vector::set(this->m_a0_lp, this->m_a0_lp, this->m_a0_hp, this->m_a0_hp);
+			coefs.a1 = Vector::set(this->m_a1_lp, this->m_a1_lp, this->m_a1_hp, this->m_a1_hp);
+			coefs.a2 = Vector::set(this->m_a2_lp, this->m_a2_lp, this->m_a2_hp, this->m_a2_hp);
+			coefs.b1 = Vector::broadcast(this->m_b1);
+			coefs.b2 = Vector::broadcast(this->m_b2);
+		}
+	}
+
+	// Linear coefficient ramp towards frequency over the next rampSamples calls of processRamped
+	void setTargetFrequency(SampleType frequency, int rampSamples)
+	{
+		Coefficients current[N_SECTIONS];
+		std::copy(std::begin(m_coefs), std::end(m_coefs), std::begin(current));
+
+		setFrequency(frequency);
+		std::copy(std::begin(m_coefs), std::end(m_coefs), std::begin(m_target));
+		std::copy(std::begin(current), std::end(current), std::begin(m_coefs));
+
+		const Vector scale = Vector::broadcast((SampleType)1 / (SampleType)rampSamples);
+
+		for (int section = 0; section < N_SECTIONS; ++section)
+		{
+			m_step[section].a0 = (m_target[section].a0 - current[section].a0) * scale;
+			m_step[section].a1 = (m_target[section].a1 - current[section].a1) * scale;
+			m_step[section].a2 = (m_target[section].a2 - current[section].a2) * scale;
+			m_step[section].b1 = (m_target[section].b1 - current[section].b1) * scale;
+			m_step[section].b2 = (m_target[section].b2 - current[section].b2) * scale;
+		}
+	}
+
+	void endRamp()
+	{
+		std::copy(std::begin(m_target), std::end(m_target), std::begin(m_coefs));
+	}
+
+	void reset()
+	{
+		for (int section = 0; section < N_SECTIONS; ++section)
+		{
+			m_x0[section] = Vector::broadcast(0);
+			m_x1[section] = Vector::broadcast(0);
+		}
+	}
+
+	void flushDenormals()
+	{
+		for (int section = 0; section < N_SECTIONS; ++section)
+		{
+			::flushDenormals<SampleType>(m_x0[section]);
+			::flushDenormals<SampleType>(m_x1[section]);
+		}
+	}
+
+	inline Vector process(Vector in)
+	{
+		Vector y = in;
+
+		for (int section = 0; section < N_SECTIONS; ++section)
+		{
+			const auto& coefs = m_coefs[section];
+			const Vector x = y;
+
+			y = coefs.a0 * x + m_x0[section];
+			m_x0[section] = coefs.a1 * x - coefs.b1 * y + m_x1[section];
+			m_x1[section] = coefs.a2 * x - coefs.b2 * y;
+		}
+
+		return y;
+	}
+
+	inline Vector processRamped(Vector in)
+	{
+		for (int section = 0; section < N_SECTIONS; ++section)
+		{
+			auto& coefs = m_coefs[section];
+			const auto& step = m_step[section];
+
+			coefs.a0 = coefs.a0 + step.a0;
+			coefs.a1 = coefs.a1 + step.a1;
+			coefs.a2 = coefs.a2 + step.a2;
+			coefs.b1 = coefs.b1 + step.b1;
+			coefs.b2 = coefs.b2 + step.b2;
+		}
+
+		return process(in);
+	}
+
+protected:
+	struct Coefficients
+	{
+		Vector a0 = Vector::broadcast(0);
+		Vector a1 = Vector::broadcast(0);
+		Vector a2 = Vector::broadcast(0);
+		Vector b1 = Vector::broadcast(0);
+		Vector b2 = Vector::broadcast(0);
+	};
+
+	Coefficients m_coefs[N_SECTIONS];
+	Coefficients m_target[N_SECTIONS];
+	Coefficients m_step[N_SECTIONS];
+
+	Vector m_x0[N_SECTIONS] = {};
+	Vector m_x1[N_SECTIONS] = {};
+};
+
+//==============================================================================
+// Phase compensation for LinkwitzRileyCascadeStereo<Order>: the all-pass the LP and HP
+// outputs sum to, as Order / 4 cascaded SecondOrderAllPass sections. Lane layout as in
+// FirstOrderAllPassStereo.
+template <int Order, typename SampleType, SimdKernel Kernel = NATIVE_KERNEL>
+class SecondOrderAllPassStereo : protected SecondOrderAllPass<SampleType>
+{
+public:
+	static_assert(Order == 4 || Order == 8, "SecondOrderAllPassStereo supports orders 4 and 8");
+
+	using Vector = typename Vector4<SampleType, Kernel>::Type;
+
+	static const int N_SECTIONS = Order / 4;
+
+	using SecondOrderAllPass<SampleType>::init;
+
+	void setFrequency(SampleType frequency)
+	{
+		for (int section = 0; section < N_SECTIONS; ++section)
+		{
+			SecondOrderAllPass<SampleType>::setFrequency(frequency, (SampleType)butterworthQ(Order / 2, section));
+
+			m_coefs[section].a0 = Vector::broadcast(this->m_a0);
+			m_coefs[section].a1 = Vector::broadcast(this->m_a1);
+		}
+	}
+
+	// Linear coefficient ramp towards frequency over the next rampSamples calls of processRamped
+	void setTargetFrequency(SampleType frequency, int rampSamples)
+	{
+		const Vector scale = Vector::broadcast((SampleType)1 / (SampleType)rampSamples);
+
+		for (int section = 0; section < N_SECTIONS; ++section)
+		{
+			SecondOrderAllPass<SampleType>::setFrequency(frequency, (SampleType)butterworthQ(Order / 2, section));
+
+			m_target[section].a0 = Vector::broadcast(this->m_a0);
+			m_target[section].a1 = Vector::broadcast(this->m_a1);
+			m_step[section].a0 = (m_target[section].a0 - m_coefs[section].a0) * scale;
+			m_step[section].a1 = (m_target[section].a1 - m_coefs[section].a1) * scale;
+		}
+	}
+
+	void endRamp()
+	{
+		std::copy(std::begin(m_target), std::end(m_target), std::begin(m_coefs));
+	}
+
+	void reset()
+	{
+		for (auto& state : m_state)
+			state = State();
+	}
+
+	void flushDenormals()
+	{
+		for (auto& state : m_state)
+		{
+			::flushDenormals<SampleType>(state.x1);
+			::flushDenormals<SampleType>(state.x2);
+			::flushDenormals<SampleType>(state.y1);
+			::flushDenormals<SampleType>(state.y2);
+		}
+	}
+
+	inline Vector process(Vector in)
+	{
+		Vector y = in;
+
+		for (int section = 0; section < N_SECTIONS; ++section)
+		{
+			const auto& coefs = m_coefs[section];
+			auto& state = m_state[section];
+			const Vector x = y;
+
+			y = coefs.a0 * (x - state.y2) + coefs.a1 * (state.x1 - state.y1) + state.x2;
+
+			state.x2 = state.x1;
+			state.x1 = x;
+			state.y2 = state.y1;
+			state.y1 = y;
+		}
+
+		return y;
+	}
+
+	inline Vector processRamped(Vector in)
+	{
+		for (int section = 0; section < N_SECTIONS; ++section)
+		{
+			m_coefs[section].a0 = m_coefs[section].a0 + m_step[section].a0;
+			m_coefs[section].a1 = m_coefs[section].a1 + m_step[section].a1;
+		}
+
+		return process(in);
+	}
+
+protected:
+	struct Coefficients
+	{
+		Vector a0 = Vector::broadcast(0);
+		Vector a1 = Vector::broadcast(0);
+	};
+
+	struct State
+	{
+		Vector x1 = Vector::broadcast(0);
+		Vector x2 = Vector::broadcast(0);
+		Vector y1 = Vector::broadcast(0);
+		Vector y2 = Vector::broadcast(0);
+	};
+
+	Coefficients m_coefs[N_SECTIONS];
+	Coefficients m_target[N_SECTIONS];
+	Coefficients m_step[N_SECTIONS];
+	State m_state[N_SECTIONS];
+};
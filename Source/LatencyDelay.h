@@ -0,0 +1,85 @@
+/*
+  ==============================================================================
+
+    Plain sample delay, so bypassed audio stays aligned with the latency
+    reported to the host.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+//==============================================================================
+template <typename SampleType>
+class LatencyDelay
+{
+public:
+	// Allocates, call from prepareToPlay
+	void prepare(int numChannels, int maximumDelay)
+	{
+		m_buffer.setSize(juce::jmax(1, numChannels), juce::jmax(1, maximumDelay));
+		setDelay(0);
+	}
+
+	// Clears the line, the delayed samples restart from silence
+	void setDelay(int delay)
+	{
+		jassert(delay <= m_buffer.getNumSamples());
+		m_delay = juce::jlimit(0, m_buffer.getNumSamples(), delay);
+		m_position = 0;
+		m_buffer.clear();
+	}
+
+	int getDelay() const { return m_delay; }
+
+	// Delays channels in place. channels holds numChannels channel pointers, at most the prepared number.
+	void process(SampleType* const* channels, int numChannels, int samples)
+	{
+		run(channels, numChannels, samples, nullptr, true);
+	}
+
+	// Feeds the line and leaves channels as they are, so a process that follows picks up the
+	// audio from here without a gap. Channels flagged in delayed are delayed in place all the same.
+	void push(SampleType* const* channels, int numChannels, int samples, const std::vector<bool>* delayed = nullptr)
+	{
+		run(channels, numChannels, samples, delayed, false);
+	}
+
+private:
+	void run(SampleType* const* channels, int numChannels, int samples, const std::vector<bool>* delayed, bool delayAll)
+	{
+		if (m_delay == 0 || numChannels == 0)
+			return;
+
+		jassert(numChannels <= m_buffer.getNumChannels());
+		int position = m_position;
+
+		for (int channel = 0; channel < numChannels; ++channel)
+		{
+			SampleType* line = m_buffer.getWritePointer(channel);
+			SampleType* data = channels[channel];
+			const bool delayChannel = delayed != nullptr ? (size_t)channel < delayed->size() && (*delayed)[(size_t)channel] : delayAll;
+			position = m_position;
+
+			for (int sample = 0; sample < samples; ++sample)
+			{
+				const SampleType value = line[position];
+				line[position] = data[sample];
+
+				if (delayChannel)
+					data[sample] = value;
+
+				if (++position == m_delay)
+					position = 0;
+			}
+		}
+
+		m_position = position;
+	}
+
+	juce::AudioBuffer<SampleType> m_buffer;
+	int m_delay = 0;
+	int m_position = 0;
+};
@@ -0,0 +1,308 @@
+/*
+  ==============================================================================
+
+    Linear phase crossover using uniformly partitioned FFT convolution.
+
+  ==============================================================================
+*/
+
+#include "LinearPhaseCrossover.h"
+
+//==============================================================================
+LinearPhaseCrossover::LinearPhaseCrossover()
+{
+}
+
+LinearPhaseCrossover::~LinearPhaseCrossover()
+{
+	m_designer.stopThread(2000);
+}
+
+void LinearPhaseCrossover::prepare(double sampleRate, int maximumBlockSize, int numBands)
+{
+	jassert(numBands >= 2 && numBands <= MAX_BANDS);
+
+	// A design in flight finishes first, the buffers it writes are reallocated here
+	m_designer.stopThread(2000);
+	m_designState.store(DESIGN_IDLE);
+
+	m_sampleRate = sampleRate;
+	m_numBands = numBands;
+
+	// About 40 ms either side of the centre tap, enough to resolve an 80 Hz crossover
+	m_filterDelay = juce::nextPowerOfTwo((int)(sampleRate * 0.04));
+	m_filterLength = 2 * m_filterDelay + 1;
+
+	m_partitionSize = juce::jlimit(64, 2048, juce::nextPowerOfTwo(maximumBlockSize));
+	m_numPartitions = (m_filterLength + m_partitionSize - 1) / m_partitionSize;
+	m_designInterval = juce::jmax(1, juce::roundToInt(DESIGN_INTERVAL * sampleRate / (double)m_partitionSize));
+
+	const int fftSize = 2 * m_partitionSize;
+	m_fft.reset(new juce::dsp::FFT(juce::roundToInt(std::log2(fftSize))));
+	m_designFft.reset(new juce::dsp::FFT(juce::roundToInt(std::log2(fftSize))));
+
+	// Blackman window
+	m_window.resize((size_t)m_filterLength);
+	const double pi = juce::MathConstants<double>::pi;
+	for (int n = 0; n < m_filterLength; ++n)
+	{
+		const double phase = (double)n / (double)(m_filterLength - 1);
+		m_window[(size_t)n] = (float)(0.42 - 0.5 * std::cos(2.0 * pi * phase) + 0.08 * std::cos(4.0 * pi * phase));
+	}
+
+	const int numFilters = m_numBands - 1;
+	for (int set = 0; set < 2; ++set)
+		m_filters[set].assign((size_t)(numFilters * m_numPartitions * complexSize()), 0.0f);
+
+	for (int channel = 0; channel < 2; ++channel)
+	{
+		m_spectra[channel].assign((size_t)(m_numPartitions * complexSize()), 0.0f);
+		m_input[channel].assign((size_t)fftSize, 0.0f);
+		m_delay[channel].assign((size_t)(m_filterDelay + m_partitionSize), 0.0f);
+	}
+
+	m_taps.assign((size_t)m_filterLength, 0.0f);
+	m_designBuffer.assign((size_t)(2 * fftSize), 0.0f);
+	m_fftBuffer.assign((size_t)(2 * fftSize), 0.0f);
+	m_accumulator.assign((size_t)complexSize(), 0.0f);
+
+	m_lowPass.setSize(2 * numFilters, m_partitionSize);
+	m_crossfade.setSize(2 * numFilters, m_partitionSize);
+	m_output.setSize(2 * m_numBands, m_partitionSize);
+
+	// Force a design with the next frequencies
+	for (auto& designed : m_designed)
+		std::fill(std::begin(designed), std::end(designed), -1.0f);
+
+	reset();
+	m_designer.startThread();
+}
+
+void LinearPhaseCrossover::reset()
+{
+	for (int channel = 0; channel < 2; ++channel)
+	{
+		std::fill(m_spectra[channel].begin(), m_spectra[channel].end(), 0.0f);
+		std::fill(m_input[channel].begin(), m_input[channel].end(), 0.0f);
+		std::fill(m_delay[channel].begin(), m_delay[channel].end(), 0.0f);
+	}
+
+	m_output.clear();
+	m_position = 0;
+	m_spectraIndex = 0;
+
+	// New frequencies after a reset are designed at the first partition
+	m_partitionsSinceDesign = m_designInterval;
+}
+
+void LinearPhaseCrossover::setFrequencies(const float* frequencies)
+{
+	std::copy(frequencies, frequencies + m_numBands - 1, m_target);
+
+	// The first design has nothing to crossfade from. Until it is made no design is requested, so
+	// the designer is idle and its buffers are free.
+	if (m_designed[m_activeSet][0] < 0.0f)
+		designFilters(m_activeSet, m_target);
+}
+
+void LinearPhaseCrossover::process(const float* left, const float* right, float* const* bands, int samples)
+{
+	const int numChannels = 2 * m_numBands;
+	const int step = right != nullptr ? 1 : 2;
+	m_channels = right != nullptr ? 2 : 1;
+	int done = 0;
+
+	while (done < samples)
+	{
+		const int chunk = juce::jmin(samples - done, m_partitionSize - m_position);
+
+		// Input goes into the newest half of the overlap-save window
+		std::copy(left + done, left + done + chunk, m_input[0].data() + m_partitionSize + m_position);
+		if (right != nullptr)
+			std::copy(right + done, right + done + chunk, m_input[1].data() + m_partitionSize + m_position);
+
+		// Output comes from the last complete partition
+		for (int channel = 0; channel < numChannels; channel += step)
+		{
+			const float* source = m_output.getReadPointer(channel, m_position);
+			std::copy(source, source + chunk, bands[channel] + done);
+		}
+
+		m_position += chunk;
+		done += chunk;
+
+		if (m_position == m_partitionSize)
+		{
+			processPartition();
+			m_position = 0;
+		}
+	}
+}
+
+void LinearPhaseCrossover::processPartition()
+{
+	const int numFilters = m_numBands - 1;
+	const int newSet = 1 - m_activeSet;
+
+	// A finished design is crossfaded to during this partition; the audio thread never designs itself
+	const bool crossfade = m_designState.load(std::memory_order_acquire) == DESIGN_READY;
+	jassert(!crossfade || m_requestSet == newSet);
+
+	for (int channel = 0; channel < m_channels; ++channel)
+	{
+		float* input = m_input[channel].data();
+		float* delay = m_delay[channel].data();
+
+		// Spectrum of the last two partitions of input
+		std::copy(input, input + 2 * m_partitionSize, m_fftBuffer.begin());
+		std::fill(m_fftBuffer.begin() + 2 * m_partitionSize, m_fftBuffer.end(), 0.0f);
+		m_fft->performRealOnlyForwardTransform(m_fftBuffer.data(), true);
+		std::copy(m_fftBuffer.begin(), m_fftBuffer.begin() + complexSize(), inputSpectrum(channel, m_spectraIndex));
+
+		// Delay line for the highest band
+		std::copy(delay + m_partitionSize, delay + m_filterDelay + m_partitionSize, delay);
+		std::copy(input + m_partitionSize, input + 2 * m_partitionSize, delay + m_filterDelay);
+
+		// Slide the overlap-save window
+		std::copy(input + m_partitionSize, input + 2 * m_partitionSize, input);
+
+		for (int filter = 0; filter < numFilters; ++filter)
+		{
+			float* lowPass = m_lowPass.getWritePointer(2 * filter + channel);
+			convolve(m_activeSet, filter, channel, lowPass);
+
+			if (crossfade)
+			{
+				float* faded = m_crossfade.getWritePointer(2 * filter + channel);
+				convolve(newSet, filter, channel, faded);
+
+				const float step = 1.0f / (float)m_partitionSize;
+				for (int sample = 0; sample < m_partitionSize; ++sample)
+				{
+					const float t = (float)(sample + 1) * step;
+					lowPass[sample] += t * (faded[sample] - lowPass[sample]);
+				}
+			}
+		}
+
+		// Bands from differences of adjacent LPs
+		for (int band = 0; band < m_numBands; ++band)
+		{
+			float* out = m_output.getWritePointer(2 * band + channel);
+			const float* upper = (band < numFilters) ? m_lowPass.getReadPointer(2 * band + channel) : delay;
+			const float* lower = (band > 0) ? m_lowPass.getReadPointer(2 * (band - 1) + channel) : nullptr;
+
+			for (int sample = 0; sample < m_partitionSize; ++sample)
+				out[sample] = upper[sample] - (lower != nullptr ? lower[sample] : 0.0f);
+		}
+	}
+
+	if (crossfade)
+	{
+		m_activeSet = newSet;
+		m_designState.store(DESIGN_IDLE, std::memory_order_relaxed);
+	}
+
+	m_spectraIndex = (m_spectraIndex + 1) % m_numPartitions;
+	requestDesign();
+}
+
+void LinearPhaseCrossover::requestDesign()
+{
+	// Frequencies moved: the next design goes to wherever the glide is, targets in between are skipped
+	m_partitionsSinceDesign = juce::jmin(m_partitionsSinceDesign + 1, m_designInterval);
+
+	if (m_partitionsSinceDesign < m_designInterval || m_designState.load(std::memory_order_relaxed) != DESIGN_IDLE)
+		return;
+
+	const int numFilters = m_numBands - 1;
+	if (std::equal(m_target, m_target + numFilters, m_designed[m_activeSet]))
+		return;
+
+	std::copy(m_target, m_target + numFilters, m_request);
+	m_requestSet = 1 - m_activeSet;
+	m_partitionsSinceDesign = 0;
+
+	m_designState.store(DESIGN_REQUESTED, std::memory_order_release);
+	m_designer.notify();
+}
+
+void LinearPhaseCrossover::Designer::run()
+{
+	while (!threadShouldExit())
+	{
+		if (m_owner.m_designState.load(std::memory_order_acquire) == DESIGN_REQUESTED)
+		{
+			m_owner.designFilters(m_owner.m_requestSet, m_owner.m_request);
+			m_owner.m_designState.store(DESIGN_READY, std::memory_order_release);
+		}
+
+		wait(-1);
+	}
+}
+
+void LinearPhaseCrossover::convolve(int set, int filter, int channel, float* out)
+{
+	const int size = complexSize();
+	float* accumulator = m_accumulator.data();
+	std::fill(m_accumulator.begin(), m_accumulator.end(), 0.0f);
+
+	// Frequency domain delay line, partition p of the filter meets the input from p partitions ago
+	for (int partition = 0; partition < m_numPartitions; ++partition)
+	{
+		const int index = (m_spectraIndex - partition + m_numPartitions) % m_numPartitions;
+		const float* x = inputSpectrum(channel, index);
+		const float* h = filterSpectrum(set, filter, partition);
+
+		for (int bin = 0; bin < size; bin += 2)
+		{
+			accumulator[bin]     += x[bin] * h[bin]     - x[bin + 1] * h[bin + 1];
+			accumulator[bin + 1] += x[bin] * h[bin + 1] + x[bin + 1] * h[bin];
+		}
+	}
+
+	std::copy(m_accumulator.begin(), m_accumulator.end(), m_fftBuffer.begin());
+	m_fft->performRealOnlyInverseTransform(m_fftBuffer.data());
+
+	// Overlap-save, the second half is the valid linear convolution
+	std::copy(m_fftBuffer.begin() + m_partitionSize, m_fftBuffer.begin() + 2 * m_partitionSize, out);
+}
+
+void LinearPhaseCrossover::designFilters(int set, const float* frequencies)
+{
+	const double pi = juce::MathConstants<double>::pi;
+	float* taps = m_taps.data();
+
+	for (int filter = 0; filter < m_numBands - 1; ++filter)
+	{
+		// Windowed sinc low-pass, normalised to unity gain at DC
+		const double cutoff = juce::jlimit(1.0, 0.49 * m_sampleRate, (double)frequencies[filter]) / m_sampleRate;
+		double sum = 0.0;
+
+		for (int n = 0; n < m_filterLength; ++n)
+		{
+			const double x = (double)(n - m_filterDelay);
+			const double sinc = (n == m_filterDelay) ? 2.0 * cutoff : std::sin(2.0 * pi * cutoff * x) / (pi * x);
+			taps[n] = (float)(sinc * m_window[(size_t)n]);
+			sum += taps[n];
+		}
+
+		const float gain = (float)(1.0 / sum);
+
+		// Spectrum of every partition, zero padded to the FFT size
+		for (int partition = 0; partition < m_numPartitions; ++partition)
+		{
+			const int start = partition * m_partitionSize;
+			const int length = juce::jmin(m_partitionSize, m_filterLength - start);
+
+			std::fill(m_designBuffer.begin(), m_designBuffer.end(), 0.0f);
+			for (int n = 0; n < length; ++n)
+				m_designBuffer[(size_t)n] = gain * taps[start + n];
+
+			m_designFft->performRealOnlyForwardTransform(m_designBuffer.data(), true);
+			std::copy(m_designBuffer.begin(), m_designBuffer.begin() + complexSize(), filterSpectrum(set, filter, partition));
+		}
+
+		m_designed[set][filter] = frequencies[filter];
+	}
+}
@@ -0,0 +1,113 @@
+/*
+  ==============================================================================
+
+    Linear phase crossover using uniformly partitioned FFT convolution.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+//==============================================================================
+// Splits a stereo signal into bands with linear phase FIR low-passes. Band k is
+// LP(k) - LP(k - 1), and the highest band is the delayed input minus the last LP, so the
+// bands sum to a pure delay. Convolution is uniformly partitioned overlap-save with a
+// partition the size of the host block, so every block does about the same FFT work.
+class LinearPhaseCrossover
+{
+public:
+	static const int MAX_BANDS = 8;
+	static constexpr double DESIGN_INTERVAL = 0.01; // seconds, at least, between designs while frequencies glide
+
+	LinearPhaseCrossover();
+	~LinearPhaseCrossover();
+
+	// Allocates, and starts the designer thread
+	void prepare(double sampleRate, int maximumBlockSize, int numBands);
+	void reset();
+
+	// A design costs a windowed sinc and the FFTs of every partition per filter, far more than a
+	// partition of convolution, so it runs on a designer thread. The first one, which has nothing to
+	// crossfade from, is made here. Later ones are picked up at a partition boundary once ready,
+	// crossfading from the old filters over one partition, at most once per DESIGN_INTERVAL.
+	void setFrequencies(const float* frequencies);
+
+	// bands[2 * k] and bands[2 * k + 1] receive left and right of band k, delayed by getLatency().
+	// right is nullptr for a mono input, then only bands[2 * k] are written.
+	void process(const float* left, const float* right, float* const* bands, int samples);
+
+	int getLatency() const { return m_partitionSize + m_filterDelay; }
+	int getFilterLength() const { return m_filterLength; }
+
+private:
+	// Designs the set the audio thread requests, while the audio thread only reads the other one
+	class Designer : public juce::Thread
+	{
+	public:
+		Designer(LinearPhaseCrossover& owner) : juce::Thread("Linear phase designer"), m_owner(owner) {}
+
+		void run() override;
+
+	private:
+		LinearPhaseCrossover& m_owner;
+	};
+
+	// Owner of the inactive filter set: the audio thread while idle or ready, the designer while requested
+	enum DesignState
+	{
+		DESIGN_IDLE,
+		DESIGN_REQUESTED,
+		DESIGN_READY
+	};
+
+	void processPartition();
+	void requestDesign();
+	void designFilters(int set, const float* frequencies);
+	void convolve(int set, int filter, int channel, float* out);
+
+	int complexSize() const { return 2 * (m_partitionSize + 1); }
+	float* filterSpectrum(int set, int filter, int partition) { return m_filters[set].data() + (filter * m_numPartitions + partition) * complexSize(); }
+	float* inputSpectrum(int channel, int partition) { return m_spectra[channel].data() + partition * complexSize(); }
+
+	std::unique_ptr<juce::dsp::FFT> m_fft;
+	std::unique_ptr<juce::dsp::FFT> m_designFft; // the designer's own, so neither thread waits on the other
+
+	double m_sampleRate = 44100.0;
+	int m_numBands = 0;
+	int m_partitionSize = 0;
+	int m_numPartitions = 0;
+	int m_filterLength = 0;
+	int m_filterDelay = 0;
+
+	int m_channels = 2;  // 1 while fed mono
+	int m_position = 0;  // fill position in the current partition
+	int m_spectraIndex = 0;
+	int m_activeSet = 0;
+	int m_designInterval = 1; // partitions
+	int m_partitionsSinceDesign = 0;
+
+	float m_target[MAX_BANDS - 1] = {};
+	float m_designed[2][MAX_BANDS - 1] = {};
+
+	Designer m_designer{ *this };
+	std::atomic<int> m_designState{ DESIGN_IDLE };
+	float m_request[MAX_BANDS - 1] = {};
+	int m_requestSet = 0;
+
+	// Designer side
+	std::vector<float> m_window;
+	std::vector<float> m_taps;
+	std::vector<float> m_designBuffer;
+	std::vector<float> m_filters[2]; // two filter sets for crossfading, spectra of all partitions of all LPs
+	std::vector<float> m_spectra[2]; // input spectra of the last m_numPartitions partitions, per channel
+	std::vector<float> m_input[2];   // last two partitions of input, per channel
+	std::vector<float> m_delay[2];   // input delayed by m_filterDelay, per channel
+	std::vector<float> m_fftBuffer;
+	std::vector<float> m_accumulator;
+
+	juce::AudioBuffer<float> m_lowPass;   // LP outputs of the last partition
+	juce::AudioBuffer<float> m_crossfade; // LP outputs of the new filter set while crossfading
+	juce::AudioBuffer<float> m_output;    // band outputs of the last partition
+};
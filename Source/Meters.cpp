@@ -0,0 +1,62 @@
+/*
+  ==============================================================================
+
+    Band level metering and its lock-free hand over to the editor.
+
+  ==============================================================================
+*/
+
+#include "Meters.h"
+
+//==============================================================================
+void MeterAccumulator::prepare(double sampleRate)
+{
+	m_windowSamples = std::max(1, (int)(sampleRate * WINDOW_TIME));
+	reset();
+}
+
+void MeterAccumulator::reset()
+{
+	for (auto& sums : m_sums)
+		sums = Sums();
+
+	m_outputPeak[0] = 0.0f;
+	m_outputPeak[1] = 0.0f;
+	m_samples = 0;
+}
+
+void MeterAccumulator::addOutputPeak(float left, float right)
+{
+	m_outputPeak[0] = std::max(m_outputPeak[0], left);
+	m_outputPeak[1] = std::max(m_outputPeak[1], right);
+}
+
+void MeterAccumulator::publishIfDue(MeterBridge& bridge)
+{
+	if (m_samples < m_windowSamples)
+		return;
+
+	MeterSnapshot snapshot;
+	const double samples = (double)m_samples;
+
+	for (int band = 0; band < ParameterSnapshot::N_BANDS; ++band)
+	{
+		const auto& sums = m_sums[band];
+		auto& levels = snapshot.band[band];
+
+		levels.midRms = (float)std::sqrt(sums.mid2 / samples);
+		levels.sideRms = (float)std::sqrt(sums.side2 / samples);
+		levels.peak = sums.peak;
+
+		// With l = m + s and r = m - s: sum(lr) = M2 - S2, sum(ll) and sum(rr) = M2 + S2 +- 2MS
+		const double energy = sums.mid2 + sums.side2;
+		const double leftRight = (energy + 2.0 * sums.midSide) * (energy - 2.0 * sums.midSide);
+		levels.correlation = leftRight > 1.0e-20 ? (float)((sums.mid2 - sums.side2) / std::sqrt(leftRight)) : 0.0f;
+	}
+
+	snapshot.outputPeak[0] = m_outputPeak[0];
+	snapshot.outputPeak[1] = m_outputPeak[1];
+
+	bridge.publish(snapshot);
+	reset();
+}
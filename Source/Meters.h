@@ -0,0 +1,135 @@
+/*
+  ==============================================================================
+
+    Band level metering and its lock-free hand over to the editor.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include "ParameterSnapshot.h"
+#include "SnapshotBridge.h"
+#include <algorithm>
+#include <cmath>
+
+//==============================================================================
+// Levels of one band after the width matrix, over the last metering window
+struct BandLevels
+{
+	float midRms = 0.0f;
+	float sideRms = 0.0f;
+	float peak = 0.0f;
+	float correlation = 0.0f; // -1 to 1, 0 for silence
+};
+
+struct MeterSnapshot
+{
+	BandLevels band[ParameterSnapshot::N_BANDS];
+	float outputPeak[2] = {};
+};
+
+// Audio thread publishes, message thread reads
+using MeterBridge = SnapshotBridge<MeterSnapshot>;
+
+//==============================================================================
+// Accumulates band levels on the audio thread. The band mid and side signals after the
+// matrix are the input ones scaled by direct + cross and direct - cross, so only sums of
+// the input M/S products are kept and the matrix is applied once per chunk.
+class MeterAccumulator
+{
+public:
+	static constexpr double WINDOW_TIME = 0.05;
+
+	void prepare(double sampleRate);
+	void reset();
+
+	// bands as in CrossoverTree::process, matrix the one applied to this chunk
+	template <typename SampleType>
+	void addBands(const SampleType* const* bands, const BandMatrix* matrix, int samples)
+	{
+		for (int band = 0; band < ParameterSnapshot::N_BANDS; ++band)
+		{
+			const SampleType* left = bands[2 * band];
+			const SampleType* right = bands[2 * band + 1];
+			const SampleType midGain = matrix[band].direct + matrix[band].cross;
+			const SampleType sideGain = matrix[band].direct - matrix[band].cross;
+			const SampleType midScale = std::abs(midGain);
+			const SampleType sideScale = std::abs(sideGain);
+
+			SampleType mid2 = 0;
+			SampleType side2 = 0;
+			SampleType midSide = 0;
+			SampleType peak = 0;
+
+			for (int sample = 0; sample < samples; ++sample)
+			{
+				const SampleType mid = (SampleType)0.5 * (left[sample] + right[sample]);
+				const SampleType side = (SampleType)0.5 * (left[sample] - right[sample]);
+
+				mid2 += mid * mid;
+				side2 += side * side;
+				midSide += mid * side;
+
+				// max(|m + s|, |m - s|) = |m| + |s|
+				peak = std::max(peak, midScale * std::abs(mid) + sideScale * std::abs(side));
+			}
+
+			auto& sums = m_sums[band];
+			sums.mid2 += (double)(midGain * midGain) * (double)mid2;
+			sums.side2 += (double)(sideGain * sideGain) * (double)side2;
+			sums.midSide += (double)(midGain * sideGain) * (double)midSide;
+			sums.peak = std::max(sums.peak, (float)peak);
+		}
+
+		m_samples += samples;
+	}
+
+	// Mono kernel bands, in bands[2 * k]. The side is silent, so only mid sums change.
+	template <typename SampleType>
+	void addBandsMono(const SampleType* const* bands, const BandMatrix* matrix, int samples)
+	{
+		for (int band = 0; band < ParameterSnapshot::N_BANDS; ++band)
+		{
+			const SampleType* in = bands[2 * band];
+			const SampleType midGain = matrix[band].direct + matrix[band].cross;
+
+			SampleType mid2 = 0;
+			SampleType peak = 0;
+
+			for (int sample = 0; sample < samples; ++sample)
+			{
+				mid2 += in[sample] * in[sample];
+				peak = std::max(peak, std::abs(in[sample]));
+			}
+
+			auto& sums = m_sums[band];
+			sums.mid2 += (double)(midGain * midGain) * (double)mid2;
+			sums.peak = std::max(sums.peak, (float)(std::abs(midGain) * peak));
+		}
+
+		m_samples += samples;
+	}
+
+	// Counts silent samples, while processing is skipped
+	void addSilence(int samples) { m_samples += samples; }
+
+	void addOutputPeak(float left, float right);
+
+	// Publishes and starts a new window once the current one is full
+	void publishIfDue(MeterBridge& bridge);
+
+private:
+	struct Sums
+	{
+		double mid2 = 0.0;
+		double side2 = 0.0;
+		double midSide = 0.0;
+		float peak = 0.0f;
+	};
+
+	Sums m_sums[ParameterSnapshot::N_BANDS];
+	float m_outputPeak[2] = {};
+	int m_samples = 0;
+	int m_windowSamples = 2048;
+};
@@ -0,0 +1,523 @@
+/*
+  ==============================================================================
+
+    Host independent multiband M/S width engine.
+
+  ==============================================================================
+*/
+
+#include "MultibandEngine.h"
+
+//==============================================================================
+void addChannelPairs(std::vector<ChannelPair>& pairs, const juce::AudioChannelSet& set, int offset)
+{
+	static const std::pair<juce::AudioChannelSet::ChannelType, juce::AudioChannelSet::ChannelType> stereoTypes[] =
+	{
+		{ juce::AudioChannelSet::left,             juce::AudioChannelSet::right },
+		{ juce::AudioChannelSet::leftSurround,     juce::AudioChannelSet::rightSurround },
+		{ juce::AudioChannelSet::leftSurroundSide, juce::AudioChannelSet::rightSurroundSide },
+		{ juce::AudioChannelSet::leftSurroundRear, juce::AudioChannelSet::rightSurroundRear },
+		{ juce::AudioChannelSet::leftCentre,       juce::AudioChannelSet::rightCentre },
+		{ juce::AudioChannelSet::wideLeft,         juce::AudioChannelSet::wideRight },
+		{ juce::AudioChannelSet::topFrontLeft,     juce::AudioChannelSet::topFrontRight },
+		{ juce::AudioChannelSet::topSideLeft,      juce::AudioChannelSet::topSideRight },
+		{ juce::AudioChannelSet::topRearLeft,      juce::AudioChannelSet::topRearRight }
+	};
+
+	const int size = set.size();
+	std::vector<bool> paired((size_t)size, false);
+
+	if (set.isDiscreteLayout())
+	{
+		// No channel roles, so neighbours pair up
+		for (int channel = 0; channel + 1 < size; channel += 2)
+		{
+			pairs.push_back({ offset + channel, offset + channel + 1 });
+			paired[(size_t)channel] = paired[(size_t)channel + 1] = true;
+		}
+	}
+	else
+	{
+		for (const auto& types : stereoTypes)
+		{
+			const int left = set.getChannelIndexForType(types.first);
+			const int right = set.getChannelIndexForType(types.second);
+
+			if (left >= 0 && right >= 0)
+			{
+				pairs.push_back({ offset + left, offset + right });
+				paired[(size_t)left] = paired[(size_t)right] = true;
+			}
+		}
+	}
+
+	for (int channel = 0; channel < size; ++channel)
+		if (!paired[(size_t)channel])
+			pairs.push_back({ offset + channel, -1 });
+}
+
+//==============================================================================
+void MultibandEngine::prepare(double sampleRate, int maximumBlockSize, int numChannels, const std::vector<ChannelPair>& pairs, const ParameterSnapshot& parameters)
+{
+	m_sampleRate = sampleRate;
+	m_blockSize = juce::jmax(1, maximumBlockSize);
+	m_numChannels = numChannels;
+	m_pairs = pairs;
+
+	m_processedChannels = 0;
+	m_unpaired.assign((size_t)juce::jmax(0, numChannels), true);
+
+	for (const auto& pair : m_pairs)
+	{
+		m_processedChannels += pair.isMono() ? 1 : 2;
+
+		for (const int channel : { pair.left, pair.right })
+			if (channel >= 0 && channel < numChannels)
+				m_unpaired[(size_t)channel] = false;
+	}
+
+	const int pairStates = juce::jmax(1, (int)m_pairs.size());
+
+	m_linearPhase.resize((size_t)pairStates);
+	for (auto& linearPhase : m_linearPhase)
+	{
+		if (linearPhase == nullptr)
+			linearPhase.reset(new LinearPhaseCrossover());
+
+		linearPhase->prepare(sampleRate, m_blockSize, N_BANDS);
+	}
+
+	m_linearPhaseInput.setSize(2, m_blockSize);
+	m_matrixSmoother.reset(juce::roundToInt(sampleRate * MATRIX_SMOOTHING_TIME));
+
+	// One binary for every machine, the crossover kernel follows the CPU found here
+	m_kernel = resolveKernel(m_requestedKernel);
+
+	// Callers pick the precision after preparing, but both are cheap enough to keep ready
+	prepareCore(m_floatCore, m_linearPhase[0]->getLatency());
+	prepareCore(m_doubleCore, m_linearPhase[0]->getLatency());
+
+	reset(parameters);
+}
+
+void MultibandEngine::reset(const ParameterSnapshot& parameters)
+{
+	for (int crossover = 0; crossover < N_BANDS - 1; ++crossover)
+		m_frequency[crossover].setCurrentAndTargetValue(parameters.frequency[crossover]);
+
+	m_slope = parameters.slope;
+	setCoreMode(parameters.linearPhase, parameters.oversampling);
+
+	m_matrixSmoother.setCurrentAndTarget(parameters.matrix);
+
+	m_silentSamples = 0;
+	m_idle = false;
+}
+
+template <typename SampleType>
+MultibandEngine::Core<SampleType>& MultibandEngine::getCore()
+{
+	if constexpr (std::is_same<SampleType, float>::value)
+		return m_floatCore;
+	else
+		return m_doubleCore;
+}
+
+template <typename SampleType>
+void MultibandEngine::prepareCore(Core<SampleType>& core, int maximumLatency)
+{
+	const int pairStates = juce::jmax(1, (int)m_pairs.size());
+	core.pairs.clear();
+
+	for (int pair = 0; pair < pairStates; ++pair)
+		core.pairs.push_back(createBandSplitter<SampleType>(m_kernel));
+
+	// Linear phase half-band FIRs keep the band phase relations, and integer latency can be compensated exactly
+	for (int stage = 0; stage < MAX_OVERSAMPLING; ++stage)
+	{
+		core.oversampling[stage].reset(new juce::dsp::Oversampling<SampleType>((size_t)juce::jmax(1, m_processedChannels), (size_t)(stage + 1), juce::dsp::Oversampling<SampleType>::filterHalfBandFIREquiripple, false, true));
+		core.oversampling[stage]->initProcessing((size_t)m_blockSize);
+		maximumLatency = juce::jmax(maximumLatency, juce::roundToInt(core.oversampling[stage]->getLatencyInSamples()));
+	}
+
+	core.bandBuffer.setSize(N_BAND_CHANNELS, m_blockSize << MAX_OVERSAMPLING);
+	core.channels.assign((size_t)m_processedChannels, nullptr);
+	core.bypassDelay.prepare(m_numChannels, maximumLatency);
+	core.bypassBuffer.setSize(juce::jmax(1, m_numChannels), m_blockSize);
+}
+
+//==============================================================================
+template <typename SampleType>
+void MultibandEngine::processBypassed(SampleType* const* channels, int samples, const ParameterSnapshot& parameters)
+{
+	auto& core = getCore<SampleType>();
+
+	jassert(core.bandBuffer.getNumSamples() > 0); // prepare has not been called
+	if (core.bandBuffer.getNumSamples() == 0 || samples == 0)
+		return;
+
+	if (parameters.linearPhase != m_linearPhaseActive || parameters.oversampling != m_oversamplingActive)
+		setCoreMode(parameters.linearPhase, parameters.oversampling);
+
+	// The DSP keeps running on a copy of the input and its output is dropped, so when the bypass
+	// ends the filter states and glides are where they would have been, and the sound carries on
+	for (int offset = 0; offset < samples; offset += m_blockSize)
+	{
+		const int chunk = juce::jmin(m_blockSize, samples - offset);
+
+		for (int channel = 0; channel < m_numChannels; ++channel)
+			core.bypassBuffer.copyFrom(channel, 0, channels[channel] + offset, chunk);
+
+		processPairs(core, core.bypassBuffer.getArrayOfWritePointers(), chunk, parameters, false);
+	}
+
+	core.bypassDelay.process(channels, m_numChannels, samples);
+}
+
+template <typename SampleType>
+void MultibandEngine::process(SampleType* const* channels, int samples, const ParameterSnapshot& parameters)
+{
+	auto& core = getCore<SampleType>();
+
+	jassert(core.bandBuffer.getNumSamples() > 0); // prepare has not been called
+	if (core.bandBuffer.getNumSamples() == 0 || samples == 0)
+		return;
+
+	if (parameters.linearPhase != m_linearPhaseActive || parameters.oversampling != m_oversamplingActive)
+		setCoreMode(parameters.linearPhase, parameters.oversampling);
+
+	// The bypass line follows the input all along, so a bypass starts with the latest audio in it.
+	// Channels no pair processes come out of it, in line with the processed ones.
+	core.bypassDelay.push(channels, m_numChannels, samples, &m_unpaired);
+
+	processPairs(core, channels, samples, parameters, m_metering);
+}
+
+template <typename SampleType>
+void MultibandEngine::processPairs(Core<SampleType>& core, SampleType* const* channels, int samples, const ParameterSnapshot& parameters, bool metering)
+{
+	const int numPairs = (int)m_pairs.size();
+	int processed = 0;
+
+	for (const auto& pair : m_pairs)
+	{
+		core.channels[(size_t)processed++] = channels[pair.left];
+		if (!pair.isMono())
+			core.channels[(size_t)processed++] = channels[pair.right];
+	}
+
+	if (numPairs == 0)
+		return;
+
+	// Digital silence in, with every tail died out: the output is silent too, so skip the DSP
+	const bool inputSilent = isSilent(core.channels.data(), samples);
+	m_silentSamples = inputSilent ? juce::jmin(m_silentSamples + samples, std::numeric_limits<int>::max() / 2) : 0;
+
+	if (m_idle && inputSilent)
+	{
+		for (auto* channel : core.channels)
+			std::fill(channel, channel + samples, (SampleType)0);
+
+		if (metering)
+			m_meters.addSilence(samples);
+
+		return;
+	}
+
+	// Sound is back: pick up the parameters as they are now
+	if (m_idle)
+		reset(parameters);
+
+	// The newly selected slope starts from cleared states, at the current crossover frequencies
+	if (parameters.slope != m_slope)
+	{
+		m_slope = parameters.slope;
+
+		float frequencies[N_BANDS - 1];
+		getCurrentFrequencies(frequencies);
+
+		for (auto& state : core.pairs)
+			state->reset(m_slope, frequencies);
+	}
+
+	// Everything from the split to the mix runs at the core rate
+	const int oversampling = m_linearPhaseActive ? 0 : m_oversamplingActive;
+
+	auto* const* bands = core.bandBuffer.getArrayOfWritePointers();
+	auto block = juce::dsp::AudioBlock<SampleType>(core.channels.data(), (size_t)m_processedChannels, (size_t)samples);
+
+	// Coefficients and matrices are updated between short chunks, which also keeps the
+	// oversampled chunk within the band buffer whatever the call length
+	const int subBlockSize = juce::jmin(m_blockSize, AUTOMATION_BLOCK_SIZE);
+
+	for (int offset = 0; offset < samples; offset += subBlockSize)
+	{
+		auto chunkBlock = block.getSubBlock((size_t)offset, (size_t)juce::jmin(subBlockSize, samples - offset));
+		auto coreBlock = oversampling > 0 ? core.oversampling[oversampling - 1]->processSamplesUp(chunkBlock) : chunkBlock;
+
+		const int chunk = (int)coreBlock.getNumSamples();
+
+		// Coefficients for the end of the chunk, ramped per sample from the current ones, the same for every pair
+		bool crossoverMoving = false;
+		float frequencies[N_BANDS - 1];
+
+		for (int crossover = 0; crossover < N_BANDS - 1; ++crossover)
+		{
+			m_frequency[crossover].setTargetValue(parameters.frequency[crossover]);
+			crossoverMoving |= m_frequency[crossover].isSmoothing();
+		}
+
+		if (crossoverMoving)
+		{
+			for (int crossover = 0; crossover < N_BANDS - 1; ++crossover)
+				frequencies[crossover] = m_frequency[crossover].skip(chunk);
+		}
+
+		const float* targetFrequencies = crossoverMoving ? frequencies : nullptr;
+
+		// Width and volume changes ramp linearly across the chunk, to the next point of the glide
+		BandMatrix matrix[N_BANDS];
+		std::copy(m_matrixSmoother.getCurrent(), m_matrixSmoother.getCurrent() + N_BANDS, matrix);
+
+		MatrixRamp matrixRamp;
+		m_matrixSmoother.setTarget(parameters.matrix);
+		bool matrixChanged = false;
+
+		if (m_matrixSmoother.isSmoothing())
+		{
+			m_matrixSmoother.skip((int)chunkBlock.getNumSamples());
+			matrixChanged = matrixRamp.prepare(matrix, m_matrixSmoother.getCurrent(), chunk);
+		}
+
+		// Each pair fills the whole vector width on its own, [LP, HP] x [left, right], so pairs run one after the other
+		int channel = 0;
+
+		for (int pair = 0; pair < numPairs; ++pair)
+		{
+			auto& state = *core.pairs[(size_t)pair];
+
+			// Mono channels skip the M/S matrix and the whole side path, only the band mid gains apply
+			if (m_pairs[(size_t)pair].isMono())
+			{
+				SampleType* in = coreBlock.getChannelPointer((size_t)channel++);
+
+				if (m_linearPhaseActive)
+					splitBandsLinearPhase(*m_linearPhase[(size_t)pair], in, (SampleType*)nullptr, bands, chunk, targetFrequencies);
+				else
+					state.splitMono(m_slope, in, bands, chunk, targetFrequencies);
+
+				if (pair == 0 && metering)
+					m_meters.addBandsMono(bands, matrix, chunk);
+
+				if (matrixChanged)
+					mixBandsMono<true>(matrix, matrixRamp.step, bands, in, chunk);
+				else
+					mixBandsMono<false>(matrix, matrixRamp.step, bands, in, chunk);
+
+				continue;
+			}
+
+			SampleType* left = coreBlock.getChannelPointer((size_t)channel++);
+			SampleType* right = coreBlock.getChannelPointer((size_t)channel++);
+
+			if (m_linearPhaseActive)
+				splitBandsLinearPhase(*m_linearPhase[(size_t)pair], left, right, bands, chunk, targetFrequencies);
+			else
+				state.split(m_slope, left, right, bands, chunk, targetFrequencies);
+
+			if (pair == 0 && metering)
+				m_meters.addBands(bands, matrix, chunk);
+
+			if (matrixChanged)
+				mixBands<true>(matrix, matrixRamp.step, bands, left, right, chunk);
+			else
+				mixBands<false>(matrix, matrixRamp.step, bands, left, right, chunk);
+		}
+
+		if (oversampling > 0)
+			core.oversampling[oversampling - 1]->processSamplesDown(chunkBlock);
+	}
+
+	// States left after the silent stretch are below audibility, the restart clears them. The input must
+	// still be silent now, and for no less than the tail, so a quiet passage between notes keeps running.
+	const int idleSamples = juce::jmax(getTailSamples(), juce::roundToInt(IDLE_DELAY * m_sampleRate));
+
+	if (inputSilent && m_silentSamples >= idleSamples && isSilent(core.channels.data(), samples))
+		m_idle = true;
+}
+
+template <typename SampleType>
+bool MultibandEngine::isSilent(const SampleType* const* channels, int samples) const
+{
+	for (int channel = 0; channel < m_processedChannels; ++channel)
+	{
+		const auto range = juce::FloatVectorOperations::findMinAndMax(channels[channel], samples);
+
+		if (juce::jmax(-range.getStart(), range.getEnd()) > (SampleType)SILENCE_LEVEL)
+			return false;
+	}
+
+	return true;
+}
+
+int MultibandEngine::getTailSamples() const
+{
+	// Linear phase FIRs ring for their full length after the latency
+	if (m_linearPhaseActive && !m_linearPhase.empty())
+		return m_linearPhase[0]->getLatency() + m_linearPhase[0]->getFilterLength();
+
+	// The IIR crossovers ring longest at the lowest crossover, 20 Hz, in the Q 1.31 section of the 48 dB
+	// slope: its envelope decays with a time constant of Q / (pi f), 21 ms, so 120 dB take 0.29 s. The
+	// oversampling FIRs add about twice their latency.
+	return juce::roundToInt(IIR_TAIL_TIME * m_sampleRate) + 2 * m_latency;
+}
+
+//==============================================================================
+void MultibandEngine::getCurrentFrequencies(float* frequencies) const
+{
+	for (int index = 0; index < N_BANDS - 1; ++index)
+		frequencies[index] = m_frequency[index].getCurrentValue();
+}
+
+template <typename SampleType>
+void MultibandEngine::splitBandsLinearPhase(LinearPhaseCrossover& crossover, const SampleType* left, const SampleType* right, SampleType* const* bands, int samples, const float* frequencies)
+{
+	if (frequencies != nullptr)
+		crossover.setFrequencies(frequencies);
+
+	if constexpr (std::is_same<SampleType, float>::value)
+	{
+		crossover.process(left, right, bands, samples);
+	}
+	else
+	{
+		// Round trip through single precision, the FFT is float only
+		float* input[2] = { m_linearPhaseInput.getWritePointer(0), right != nullptr ? m_linearPhaseInput.getWritePointer(1) : nullptr };
+		std::copy(left, left + samples, input[0]);
+		if (right != nullptr)
+			std::copy(right, right + samples, input[1]);
+
+		auto* const* floatBands = m_floatCore.bandBuffer.getArrayOfWritePointers();
+		crossover.process(input[0], input[1], floatBands, samples);
+
+		for (int channel = 0; channel < N_BAND_CHANNELS; channel += (right != nullptr ? 1 : 2))
+			std::copy(floatBands[channel], floatBands[channel] + samples, bands[channel]);
+	}
+}
+
+template <typename SampleType>
+void MultibandEngine::resetCore(Core<SampleType>& core, int coreRate)
+{
+	float frequencies[N_BANDS - 1];
+	getCurrentFrequencies(frequencies);
+
+	for (auto& state : core.pairs)
+	{
+		state->init(coreRate);
+
+		for (int slope = 0; slope < 3; ++slope)
+			state->reset(slope, frequencies);
+	}
+
+	for (auto& stage : core.oversampling)
+		stage->reset();
+}
+
+void MultibandEngine::setCoreMode(bool linearPhase, int oversampling)
+{
+	m_linearPhaseActive = linearPhase;
+	m_oversamplingActive = oversampling;
+
+	const int coreOversampling = linearPhase ? 0 : oversampling;
+	const double coreRate = m_sampleRate * (double)(1 << coreOversampling);
+
+	// Frequencies keep gliding from where they are, with the smoothing time kept at the new rate
+	for (int crossover = 0; crossover < N_BANDS - 1; ++crossover)
+	{
+		const float frequency = m_frequency[crossover].getCurrentValue();
+		const float target = m_frequency[crossover].getTargetValue();
+		m_frequency[crossover].reset(coreRate, FREQUENCY_SMOOTHING_TIME);
+		m_frequency[crossover].setCurrentAndTargetValue(frequency);
+		m_frequency[crossover].setTargetValue(target);
+	}
+
+	m_meters.prepare(coreRate);
+
+	// Whichever crossover takes over starts from cleared states
+	resetCore(m_floatCore, (int)coreRate);
+	resetCore(m_doubleCore, (int)coreRate);
+
+	float frequencies[N_BANDS - 1];
+	getCurrentFrequencies(frequencies);
+
+	for (auto& crossover : m_linearPhase)
+	{
+		crossover->reset();
+		crossover->setFrequencies(frequencies);
+	}
+
+	m_latency = 0;
+	if (linearPhase)
+		m_latency = m_linearPhase[0]->getLatency();
+	else if (coreOversampling > 0)
+		m_latency = juce::roundToInt(m_floatCore.oversampling[coreOversampling - 1]->getLatencyInSamples());
+
+	// The lines keep their audio while the latency stays, and restart from silence when it changes
+	if (m_floatCore.bypassDelay.getDelay() != m_latency)
+		m_floatCore.bypassDelay.setDelay(m_latency);
+
+	if (m_doubleCore.bypassDelay.getDelay() != m_latency)
+		m_doubleCore.bypassDelay.setDelay(m_latency);
+}
+
+//==============================================================================
+template <bool ramp, typename SampleType>
+void MultibandEngine::mixBands(const BandMatrix* matrix, const BandMatrix* step, const SampleType* const* bands, SampleType* left, SampleType* right, int samples)
+{
+	// Independent iterations with no carried state, so this loop vectorizes, ramp included
+	for (int sample = 0; sample < samples; ++sample)
+	{
+		const SampleType t = ramp ? (SampleType)sample : 0;
+		SampleType sumLeft = 0;
+		SampleType sumRight = 0;
+
+		for (int band = 0; band < N_BANDS; ++band)
+		{
+			const SampleType direct = matrix[band].direct + t * step[band].direct;
+			const SampleType cross = matrix[band].cross + t * step[band].cross;
+			const SampleType bandLeft = bands[2 * band][sample];
+			const SampleType bandRight = bands[2 * band + 1][sample];
+
+			sumLeft += direct * bandLeft + cross * bandRight;
+			sumRight += cross * bandLeft + direct * bandRight;
+		}
+
+		left[sample] = sumLeft;
+		right[sample] = sumRight;
+	}
+}
+
+template <bool ramp, typename SampleType>
+void MultibandEngine::mixBandsMono(const BandMatrix* matrix, const BandMatrix* step, const SampleType* const* bands, SampleType* out, int samples)
+{
+	// With left equal to right, direct + cross is the whole matrix
+	for (int sample = 0; sample < samples; ++sample)
+	{
+		const SampleType t = ramp ? (SampleType)sample : 0;
+		SampleType sum = 0;
+
+		for (int band = 0; band < N_BANDS; ++band)
+		{
+			const SampleType gain = matrix[band].direct + matrix[band].cross + t * (step[band].direct + step[band].cross);
+			sum += gain * bands[2 * band][sample];
+		}
+
+		out[sample] = sum;
+	}
+}
+
+//==============================================================================
+template void MultibandEngine::process<float>(float* const*, int, const ParameterSnapshot&);
+template void MultibandEngine::process<double>(double* const*, int, const ParameterSnapshot&);
+template void MultibandEngine::processBypassed<float>(float* const*, int, const ParameterSnapshot&);
+template void MultibandEngine::processBypassed<double>(double* const*, int, const ParameterSnapshot&);
@@ -0,0 +1,179 @@
+/*
+  ==============================================================================
+
+    Host independent multiband M/S width engine.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "Filters.h"
+#include "CrossoverKernels.h"
+#include "LinearPhaseCrossover.h"
+#include "ParameterSnapshot.h"
+#include "Meters.h"
+#include "LatencyDelay.h"
+
+//==============================================================================
+// Left and right channel of a stereo pair in the process buffer, or a lone channel
+// for the mono kernel with right set to -1
+struct ChannelPair
+{
+	int left;
+	int right;
+
+	bool isMono() const { return right < 0; }
+};
+
+// Appends the pairs of a layout whose channels start at offset in the process buffer: left and
+// right of each stereo role, neighbours in a discrete layout, then every channel left over on its own
+void addChannelPairs(std::vector<ChannelPair>& pairs, const juce::AudioChannelSet& set, int offset);
+
+//==============================================================================
+// All of the plugin DSP behind plain channel pointers and an explicit ParameterSnapshot,
+// with no juce::AudioProcessor or parameter objects, so offline tools can run it without
+// hosting the plugin. prepare allocates; process and processBypassed do not, and must be
+// called from one thread. Single and double precision each keep their own filter states.
+class MultibandEngine
+{
+public:
+	static const int N_BANDS = ParameterSnapshot::N_BANDS;
+	static const int MAX_OVERSAMPLING = 2; // log2, 4x
+	static const int AUTOMATION_BLOCK_SIZE = 32; // samples between coefficient and matrix updates
+	static constexpr double FREQUENCY_SMOOTHING_TIME = 0.05;
+	static constexpr double MATRIX_SMOOTHING_TIME = 0.02;
+	static constexpr float SILENCE_LEVEL = 1.0e-6f; // -120 dB, below it input counts as silence
+	static constexpr double IIR_TAIL_TIME = 0.5; // seconds for the IIR crossovers to ring down to SILENCE_LEVEL
+	static constexpr double IDLE_DELAY = 0.1; // seconds of silent input, at least, before the DSP stops
+
+	// process gets numChannels channels, of which pairs picks the ones to process and how; the
+	// rest are only delayed by the latency, to stay aligned with them. Ends with reset(parameters).
+	void prepare(double sampleRate, int maximumBlockSize, int numChannels, const std::vector<ChannelPair>& pairs, const ParameterSnapshot& parameters);
+
+	// Clears all states and starts at parameters without gliding
+	void reset(const ParameterSnapshot& parameters);
+
+	// Crossover kernel from the next prepare on. Auto, the default, picks the fastest the CPU
+	// supports; a forced kernel the CPU or binary lacks falls back to the same.
+	void setKernel(SimdKernel kernel) { m_requestedKernel = kernel; }
+	SimdKernel getKernel() const { return m_kernel; } // in use since the last prepare
+
+	// In place, any number of samples. Crossover frequencies and band matrices glide towards
+	// parameters, slope, phase and oversampling switch at the start of the call. parameters.slope
+	// is 0, 1 or 2 for Linkwitz-Riley 12, 24 or 48 dB/oct, anything else runs 12. Callers set
+	// FTZ/DAZ around it, e.g. with juce::ScopedNoDenormals, once per host block.
+	template <typename SampleType>
+	void process(SampleType* const* channels, int samples, const ParameterSnapshot& parameters);
+
+	// Delays the input by the latency parameters call for, so hosts compensate bypassed and
+	// processed audio the same. process feeds the delay too, so bypass takes over without a
+	// gap, and the DSP runs on underneath with its output dropped, so process takes back over
+	// without one. Costs as much as process.
+	template <typename SampleType>
+	void processBypassed(SampleType* const* channels, int samples, const ParameterSnapshot& parameters);
+
+	// Crossover frequencies as far as they have glided, N_BANDS - 1 of them. Same thread as process.
+	void getCurrentFrequencies(float* frequencies) const;
+
+	int getLatency() const { return m_latency; }
+	// Samples the output rings on after the input stops, at the host rate
+	int getTailSamples() const;
+
+	// Band levels of the first pair, for displays. Off by default, as it costs a pass over the bands.
+	void setMetering(bool enabled) { m_metering = enabled; }
+	MeterAccumulator& getMeters() { return m_meters; }
+
+private:
+	//==============================================================================
+	// Scratch channels of Core::bandBuffer, band k is in channels 2k (left) and 2k + 1 (right)
+	static const int N_BAND_CHANNELS = 2 * N_BANDS;
+
+	// Processing state that depends on the sample type, one set per precision
+	template <typename SampleType>
+	struct Core
+	{
+		// Filter states, one per entry of m_pairs, and at least one so latencies are known before any layout is
+		std::vector<std::unique_ptr<BandSplitter<SampleType>>> pairs;
+
+		// The IIR crossovers run oversampled, so their bilinear warping does not depend on the host rate.
+		// oversampling[k] is the 2^(k + 1) stage over all processed channels, the linear phase
+		// crossover always runs at the host rate.
+		std::unique_ptr<juce::dsp::Oversampling<SampleType>> oversampling[MAX_OVERSAMPLING];
+
+		// Sized for the block at the highest oversampling rate, shared by the pairs in turn
+		juce::AudioBuffer<SampleType> bandBuffer;
+
+		// Filled from m_pairs at the start of each block, in the same order
+		std::vector<SampleType*> channels;
+
+		// Input delayed by the latency while bypassed
+		LatencyDelay<SampleType> bypassDelay;
+
+		// Copy of the input the DSP runs on while bypassed, m_numChannels by the block size
+		juce::AudioBuffer<SampleType> bypassBuffer;
+	};
+
+	template <typename SampleType>
+	Core<SampleType>& getCore();
+	template <typename SampleType>
+	void prepareCore(Core<SampleType>& core, int maximumLatency);
+	template <typename SampleType>
+	void resetCore(Core<SampleType>& core, int coreRate);
+
+	// Everything after the bypass line: the paired channels in place, through the idle check, split and mix
+	template <typename SampleType>
+	void processPairs(Core<SampleType>& core, SampleType* const* channels, int samples, const ParameterSnapshot& parameters, bool metering);
+
+	// frequencies are the chunk end targets while the crossovers glide, nullptr otherwise. right is
+	// nullptr for a mono channel.
+	template <typename SampleType>
+	void splitBandsLinearPhase(LinearPhaseCrossover& crossover, const SampleType* left, const SampleType* right, SampleType* const* bands, int samples, const float* frequencies);
+	void setCoreMode(bool linearPhase, int oversampling);
+
+	template <typename SampleType>
+	bool isSilent(const SampleType* const* channels, int samples) const;
+
+	template <bool ramp, typename SampleType>
+	void mixBands(const BandMatrix* matrix, const BandMatrix* step, const SampleType* const* bands, SampleType* left, SampleType* right, int samples);
+	template <bool ramp, typename SampleType>
+	void mixBandsMono(const BandMatrix* matrix, const BandMatrix* step, const SampleType* const* bands, SampleType* out, int samples);
+
+	//==============================================================================
+	Core<float> m_floatCore;
+	Core<double> m_doubleCore;
+	int m_slope = 0;
+	SimdKernel m_requestedKernel = SimdKernel::Auto;
+	SimdKernel m_kernel = SimdKernel::Scalar;
+	int m_oversamplingActive = 0;
+	int m_latency = 0;
+
+	std::vector<ChannelPair> m_pairs;
+	std::vector<bool> m_unpaired; // per channel, true for the ones no pair processes
+	int m_numChannels = 0;
+	int m_processedChannels = 0;
+
+	// Replace the IIR crossovers when the Phase parameter is Linear, adding latency. One per pair, in
+	// single precision only; double precision blocks go through m_linearPhaseInput.
+	std::vector<std::unique_ptr<LinearPhaseCrossover>> m_linearPhase;
+	juce::AudioBuffer<float> m_linearPhaseInput;
+	bool m_linearPhaseActive = false;
+
+	double m_sampleRate = 44100.0;
+	int m_blockSize = 0;
+
+	// Crossover frequencies glide, and filter coefficients are only recalculated while they move
+	juce::SmoothedValue<float, juce::ValueSmoothingTypes::Multiplicative> m_frequency[N_BANDS - 1];
+
+	// Width and volume glide at the host rate, chunks ramp between points of the glide
+	MatrixSmoother m_matrixSmoother;
+
+	// Idle once the input has been silent for longer than the tail and the output died out too,
+	// processing restarts from cleared states with the next sound
+	int m_silentSamples = 0;
+	bool m_idle = false;
+
+	MeterAccumulator m_meters;
+	bool m_metering = false;
+};
@@ -0,0 +1,104 @@
+/*
+  ==============================================================================
+
+    Parameter snapshot, the band matrix derived from it and its smoothing.
+
+  ==============================================================================
+*/
+
+#include "ParameterSnapshot.h"
+#include <cmath>
+
+//==============================================================================
+// Mid attenuation at full width, 1 - (-8 dB as gain)
+const float ParameterSnapshot::MID_ATTENUATION = 1.0f - std::pow(10.0f, -8.0f / 20.0f);
+
+void ParameterSnapshot::update()
+{
+	// MS encoding, width, MS decoding, volume and the 0.5 mix gain collapse into one matrix per band
+	const float gain = 0.5f * std::pow(10.0f, volume / 20.0f);
+
+	for (int band = 0; band < N_BANDS; ++band)
+	{
+		const float w = width[band];
+		const float midFactor = (w < 1.0f) ? 1.0f + (1.0f - w) * 0.5f : 1.0f - (MID_ATTENUATION * (w - 1.0f));
+		const float sideFactor = w;
+
+		matrix[band].direct = gain * (midFactor + sideFactor);
+		matrix[band].cross = gain * (midFactor - sideFactor);
+	}
+}
+
+//==============================================================================
+bool MatrixRamp::prepare(const BandMatrix* from, const BandMatrix* to, int samples)
+{
+	bool changed = false;
+
+	for (int band = 0; band < ParameterSnapshot::N_BANDS; ++band)
+	{
+		changed |= from[band].direct != to[band].direct || from[band].cross != to[band].cross;
+		step[band].direct = (to[band].direct - from[band].direct) / (float)samples;
+		step[band].cross = (to[band].cross - from[band].cross) / (float)samples;
+	}
+
+	return changed;
+}
+
+//==============================================================================
+void MatrixSmoother::reset(int rampSamples)
+{
+	m_rampSamples = rampSamples > 1 ? rampSamples : 1;
+	setCurrentAndTarget(m_target);
+}
+
+void MatrixSmoother::setCurrentAndTarget(const BandMatrix* matrix)
+{
+	for (int band = 0; band < ParameterSnapshot::N_BANDS; ++band)
+	{
+		m_current[band] = matrix[band];
+		m_target[band] = matrix[band];
+	}
+
+	m_countdown = 0;
+}
+
+void MatrixSmoother::setTarget(const BandMatrix* target)
+{
+	bool changed = false;
+
+	for (int band = 0; band < ParameterSnapshot::N_BANDS; ++band)
+		changed |= target[band].direct != m_target[band].direct || target[band].cross != m_target[band].cross;
+
+	if (!changed)
+		return;
+
+	for (int band = 0; band < ParameterSnapshot::N_BANDS; ++band)
+	{
+		m_target[band] = target[band];
+		m_step[band].direct = (target[band].direct - m_current[band].direct) / (float)m_rampSamples;
+		m_step[band].cross = (target[band].cross - m_current[band].cross) / (float)m_rampSamples;
+	}
+
+	m_countdown = m_rampSamples;
+}
+
+void MatrixSmoother::skip(int samples)
+{
+	if (samples >= m_countdown)
+	{
+		// Land exactly on the target, without accumulated rounding
+		for (int band = 0; band < ParameterSnapshot::N_BANDS; ++band)
+			m_current[band] = m_target[band];
+
+		m_countdown = 0;
+		return;
+	}
+
+	for (int band = 0; band < ParameterSnapshot::N_BANDS; ++band)
+	{
+		m_current[band].direct += m_step[band].direct * (float)samples;
+		m_current[band].cross += m_step[band].cross * (float)samples;
+	}
+
+	m_countdown -= samples;
+}
@@ -0,0 +1,77 @@
+/*
+  ==============================================================================
+
+    Parameter snapshot, the band matrix derived from it and its smoothing.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+//==============================================================================
+// Per band stereo matrix, left = direct * L + cross * R, right = cross * L + direct * R
+struct BandMatrix
+{
+	float direct = 0.0f;
+	float cross = 0.0f;
+};
+
+//==============================================================================
+// Parameter values read at the start of each block and again every automation sub-block.
+// update() derives the band matrices, so the sample loops only see a multiply-add matrix.
+class ParameterSnapshot
+{
+public:
+	static const int N_BANDS = 3;
+
+	void update();
+
+	float width[N_BANDS] = { 1.0f, 1.0f, 1.0f };
+	float frequency[N_BANDS - 1] = { 440.0f, 3520.5f };
+	float volume = 0.0f; // dB
+	int slope = 0;       // 0, 1, 2 for 12, 24, 48 dB/oct, as the Slope parameter lists them
+	bool linearPhase = false;
+	int oversampling = 0; // log2 of the oversampling factor
+
+	BandMatrix matrix[N_BANDS];
+
+private:
+	static const float MID_ATTENUATION;
+};
+
+//==============================================================================
+// Per sample increments that move one set of band matrices to another over a chunk
+class MatrixRamp
+{
+public:
+	// Returns true if the matrices differ, i.e. ramping is needed
+	bool prepare(const BandMatrix* from, const BandMatrix* to, int samples);
+
+	BandMatrix step[ParameterSnapshot::N_BANDS];
+};
+
+//==============================================================================
+// Linear glide of the band matrices towards the latest parameter values, over a fixed
+// number of samples, so width and volume automation sound the same at any block size
+class MatrixSmoother
+{
+public:
+	void reset(int rampSamples);
+	void setCurrentAndTarget(const BandMatrix* matrix);
+
+	// Restarts the glide from the current matrices if target differs from the last one
+	void setTarget(const BandMatrix* target);
+
+	// Moves the current matrices the given number of samples along the glide
+	void skip(int samples);
+
+	bool isSmoothing() const { return m_countdown > 0; }
+	const BandMatrix* getCurrent() const { return m_current; }
+
+private:
+	BandMatrix m_current[ParameterSnapshot::N_BANDS];
+	BandMatrix m_target[ParameterSnapshot::N_BANDS];
+	BandMatrix m_step[ParameterSnapshot::N_BANDS];
+	int m_rampSamples = 1;
+	int m_countdown = 0;
+};
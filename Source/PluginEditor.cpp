@@ -15,9 +15,59 @@ const juce::Colour ZazzLookAndFeel::lightColour = juce::Colour::fromHSV(0.48f, 0
 const juce::Colour ZazzLookAndFeel::mediumColour = juce::Colour::fromHSV(0.48f, 0.5f, 0.5f, 1.0f);
 const juce::Colour ZazzLookAndFeel::darkColour = juce::Colour::fromHSV(0.48f, 0.5f, 0.4f, 1.0f);
 
+void ZazzLookAndFeel::drawRotarySlider(juce::Graphics& g, int x, int y, int width, int height, float sliderPos, const float rotaryStartAngle, const float rotaryEndAngle, juce::Slider&)
+{
+	const auto& cache = getRotaryCache(width, height, g.getInternalContext().getPhysicalPixelScaleFactor());
+	auto centreX = (float)x + (float)width  * 0.5f;
+	auto centreY = (float)y + (float)height * 0.5f;
+	auto angle = rotaryStartAngle + sliderPos * (rotaryEndAngle - rotaryStartAngle);
+
+	// outline
+	g.drawImage(cache.ring, juce::Rectangle<float>((float)x, (float)y, (float)width, (float)height), juce::RectanglePlacement::stretchToFit);
+
+	// pointer
+	g.setColour(mediumColour);
+	g.fillPath(cache.pointer, juce::AffineTransform::rotation(angle).translated(centreX, centreY));
+}
+
+ZazzLookAndFeel::RotaryCache& ZazzLookAndFeel::getRotaryCache(int width, int height, float scale)
+{
+	for (auto& cache : m_rotaryCache)
+	{
+		if (cache.width == width && cache.height == height && cache.scale == scale)
+			return cache;
+	}
+
+	auto& cache = m_rotaryCache[m_nextRotaryCache];
+	m_nextRotaryCache = (m_nextRotaryCache + 1) % N_ROTARY_CACHES;
+
+	cache.width = width;
+	cache.height = height;
+	cache.scale = scale;
+
+	auto radius = ((float)juce::jmin(width / 2, height / 2) - 4.0f) * 0.9f;
+	const float lineThickness = height / 28.0f;
+
+	// Ring at the physical resolution, so it stays sharp on scaled displays
+	cache.ring = juce::Image(juce::Image::ARGB, juce::jmax(1, juce::roundToInt(width * scale)), juce::jmax(1, juce::roundToInt(height * scale)), true);
+	juce::Graphics g(cache.ring);
+	g.addTransform(juce::AffineTransform::scale(scale));
+	g.setColour(mediumColour);
+	g.drawEllipse((float)width * 0.5f - radius, (float)height * 0.5f - radius, radius * 2.0f, radius * 2.0f, lineThickness);
+
+	// Pointer around the origin, rotated into place when drawn
+	auto pointerLength = radius * 0.2f;
+	auto pointerThickness = lineThickness;
+	cache.pointer.clear();
+	cache.pointer.addRectangle(-pointerThickness * 0.5f, -radius, pointerThickness, pointerLength);
+
+	return cache;
+}
+
 //==============================================================================
 MultibandMSAudioProcessorEditor::MultibandMSAudioProcessorEditor (MultibandMSAudioProcessor& p, juce::AudioProcessorValueTreeState& vts)
-    : AudioProcessorEditor (&p), audioProcessor (p), valueTreeState(vts)
+    : AudioProcessorEditor (&p), audioProcessor (p), valueTreeState(vts),
+	m_analyzer(p.getAnalyzerFifo())
 {	
 	const int fonthHeight = (int)(SLIDER_WIDTH / FONT_DIVISOR);
 
@@ -40,21 +90,78 @@ MultibandMSAudioProcessorEditor::MultibandMSAudioProcessorEditor (MultibandMSAud
 		m_sliderAttachment[i].reset(new SliderAttachment(valueTreeState, MultibandMSAudioProcessor::paramsNames[i], slider));
 	}
 
+	//Slope
+	m_slope.setLookAndFeel(&zazzLookAndFeel);
+	m_slope.addItemList(MultibandMSAudioProcessor::slopeNames, 1);
+	m_slope.setJustificationType(juce::Justification::centred);
+	addAndMakeVisible(m_slope);
+	m_slopeAttachment.reset(new ComboBoxAttachment(valueTreeState, MultibandMSAudioProcessor::paramsNames[N_SLIDERS], m_slope));
+
+	//Phase
+	m_phase.setLookAndFeel(&zazzLookAndFeel);
+	m_phase.addItemList(MultibandMSAudioProcessor::phaseNames, 1);
+	m_phase.setJustificationType(juce::Justification::centred);
+	addAndMakeVisible(m_phase);
+	m_phaseAttachment.reset(new ComboBoxAttachment(valueTreeState, MultibandMSAudioProcessor::paramsNames[N_SLIDERS + 1], m_phase));
+
+	//Oversampling
+	m_oversampling.setLookAndFeel(&zazzLookAndFeel);
+	m_oversampling.addItemList(MultibandMSAudioProcessor::oversamplingNames, 1);
+	m_oversampling.setJustificationType(juce::Justification::centred);
+	addAndMakeVisible(m_oversampling);
+	m_oversamplingAttachment.reset(new ComboBoxAttachment(valueTreeState, MultibandMSAudioProcessor::paramsNames[N_SLIDERS + 2], m_oversampling));
+
+	//A/B compare
+	m_compare.setLookAndFeel(&zazzLookAndFeel);
+	m_compare.setClickingTogglesState(true);
+	addAndMakeVisible(m_compare);
+	m_compareAttachment.reset(new ButtonAttachment(valueTreeState, MultibandMSAudioProcessor::paramsNames[N_SLIDERS + 3], m_compare));
+
+	for (int slot = 0; slot < 2; ++slot)
+	{
+		m_storeSnapshot[slot].setLookAndFeel(&zazzLookAndFeel);
+		m_storeSnapshot[slot].onClick = [this, slot] { audioProcessor.storeSnapshot(slot); };
+		addAndMakeVisible(m_storeSnapshot[slot]);
+	}
+
+	m_morph.setLookAndFeel(&zazzLookAndFeel);
+	m_morph.setSliderStyle(juce::Slider::SliderStyle::LinearHorizontal);
+	m_morph.setTextBoxStyle(juce::Slider::NoTextBox, false, 0, 0);
+	addAndMakeVisible(m_morph);
+	m_morphAttachment.reset(new SliderAttachment(valueTreeState, MultibandMSAudioProcessor::paramsNames[N_SLIDERS + 4], m_morph));
+
 	//Plugin and developer name
 	m_pluginName.setText("Multiband MS", juce::dontSendNotification);
 	m_pluginName.setFont(juce::Font(fonthHeight, juce::Font::bold));
 	m_pluginName.setJustificationType(juce::Justification::centred);
+	m_pluginName.setColour(juce::Label::textColourId, ZazzLookAndFeel::mediumColour);
 	addAndMakeVisible(m_pluginName);
 
+	//Meters
+	for (auto& meter : m_meters)
+	{
+		meter.setInterceptsMouseClicks(false, false);
+		addAndMakeVisible(meter);
+	}
+
+	m_outputMeter.setInterceptsMouseClicks(false, false);
+	m_outputMeter.setShowCorrelation(false);
+	addAndMakeVisible(m_outputMeter);
+
+	//Analyzer
+	addAndMakeVisible(m_analyzer);
+
 	m_developerName.setText("zazz", juce::dontSendNotification);
 	m_developerName.setFont(juce::Font(fonthHeight, juce::Font::bold));
 	m_developerName.setJustificationType(juce::Justification::centred);
+	m_developerName.setColour(juce::Label::textColourId, ZazzLookAndFeel::mediumColour);
 	addAndMakeVisible(m_developerName);
 
 	// Canvas
+	setOpaque(true);
 	setResizable(true, true);
 	const float width = 5.6f * SLIDER_WIDTH;
-	const float height = SLIDER_WIDTH + 2 * LOGO_HEIGHT;
+	const float height = SLIDER_WIDTH + 2 * LOGO_HEIGHT + ANALYZER_HEIGHT;
 	setSize(width, height);
 
 	if (auto* constrainer = getConstrainer())
@@ -63,14 +170,41 @@ MultibandMSAudioProcessorEditor::MultibandMSAudioProcessorEditor (MultibandMSAud
 		constrainer->setFixedAspectRatio(ratio);
 		constrainer->setSizeLimits((int)(width * 0.7f), (int)(height * 0.7f), (int)(width * 2.0f), (int)(height * 2.0f));
 	}
+
+	startTimerHz(METER_RATE);
 }
 
 MultibandMSAudioProcessorEditor::~MultibandMSAudioProcessorEditor()
 {
+	stopTimer();
+	m_slope.setLookAndFeel(nullptr);
+	m_phase.setLookAndFeel(nullptr);
+	m_oversampling.setLookAndFeel(nullptr);
+	m_compare.setLookAndFeel(nullptr);
+	m_storeSnapshot[0].setLookAndFeel(nullptr);
+	m_storeSnapshot[1].setLookAndFeel(nullptr);
+	m_morph.setLookAndFeel(nullptr);
 }
 
 //==============================================================================
 void MultibandMSAudioProcessorEditor::paint (juce::Graphics& g)
+{
+	const float scale = g.getInternalContext().getPhysicalPixelScaleFactor();
+
+	if (m_background.isNull() || m_backgroundScale != scale)
+	{
+		m_background = juce::Image(juce::Image::RGB, juce::jmax(1, juce::roundToInt(getWidth() * scale)), juce::jmax(1, juce::roundToInt(getHeight() * scale)), false);
+		m_backgroundScale = scale;
+
+		juce::Graphics backgroundGraphics(m_background);
+		backgroundGraphics.addTransform(juce::AffineTransform::scale(scale));
+		drawBackground(backgroundGraphics);
+	}
+
+	g.drawImage(m_background, getLocalBounds().toFloat(), juce::RectanglePlacement::stretchToFit);
+}
+
+void MultibandMSAudioProcessorEditor::drawBackground(juce::Graphics& g)
 {
 	// Background
 	g.fillAll(ZazzLookAndFeel::lightColour);
@@ -78,7 +212,7 @@ void MultibandMSAudioProcessorEditor::paint (juce::Graphics& g)
 	// Lines
 	g.setColour(ZazzLookAndFeel::mediumColour);
 	const int width = getWidth();
-	const int height = getHeight();
+	const int height = getControlsHeight();
 	const int widthSlider = getSliderWidth();
 	const int heightSlider = (int)(height * ((float)SLIDER_WIDTH / (float)(SLIDER_WIDTH + 2 * LOGO_HEIGHT)));
 	const int heightLogo = (int)(height * ((float)LOGO_HEIGHT / (float)(SLIDER_WIDTH + 2 * LOGO_HEIGHT)));
@@ -116,6 +250,38 @@ void MultibandMSAudioProcessorEditor::paint (juce::Graphics& g)
 
 	g.fillRect(rectangle);
 
+	// Slope background
+	rectangle.setSize(widthSlider, heightLogo);
+	rectangle.setPosition((int)(width - 1.5f * widthSlider), 0);
+	rectangle.removeFromLeft((int)(removeRatio1 * widthSlider));
+	rectangle.removeFromRight((int)(removeRatio1 * widthSlider));
+
+	g.fillRect(rectangle);
+
+	// A/B compare background
+	rectangle.setSize((int)(width - 3.0f * widthSlider), heightLogo);
+	rectangle.setPosition((int)(1.5f * widthSlider), 0);
+	rectangle.removeFromLeft((int)(removeRatio1 * widthSlider));
+	rectangle.removeFromRight((int)(removeRatio1 * widthSlider));
+
+	g.fillRect(rectangle);
+
+	// Phase background
+	rectangle.setSize(widthSlider, heightLogo);
+	rectangle.setPosition((int)(0.5f * widthSlider), heightLogo + heightSlider);
+	rectangle.removeFromLeft((int)(removeRatio1 * widthSlider));
+	rectangle.removeFromRight((int)(removeRatio1 * widthSlider));
+
+	g.fillRect(rectangle);
+
+	// Oversampling background
+	rectangle.setSize(widthSlider, heightLogo);
+	rectangle.setPosition((int)(0.5f * (width - widthSlider)), heightLogo + heightSlider);
+	rectangle.removeFromLeft((int)(removeRatio1 * widthSlider));
+	rectangle.removeFromRight((int)(removeRatio1 * widthSlider));
+
+	g.fillRect(rectangle);
+
 	// Developer name background
 	rectangle.setSize(widthSlider, heightLogo);
 	rectangle.setPosition((int)(width - 1.5f * widthSlider), heightLogo + heightSlider);
@@ -124,17 +290,26 @@ void MultibandMSAudioProcessorEditor::paint (juce::Graphics& g)
 	rectangle.removeFromRight((int)(removeRatio2 * widthSlider));
 
 	g.fillRect(rectangle);
+
+	// Analyzer panel, drawn over by the analyzer view
+	g.setColour(ZazzLookAndFeel::darkColour);
+	g.fillRect(getAnalyzerBounds());
 }
 
 void MultibandMSAudioProcessorEditor::resized()
 {
 	const int width = getWidth();
 	const int widthSlider = getSliderWidth();
-	const int height = getHeight();
+	const int height = getControlsHeight();
 	const int sliderPositionY = (int)(height * ((float)LOGO_HEIGHT / (float)(SLIDER_WIDTH + 2 * LOGO_HEIGHT)));
 	const float fonthHeight = (float)height / (float)FONT_DIVISOR;
 	const int labelOffset = (int)(SLIDER_WIDTH / FONT_DIVISOR) + 5;
 
+	// Fonts and the background only change with the size
+	const bool fontChanged = fonthHeight != m_fontHeight;
+	m_fontHeight = fonthHeight;
+	m_background = juce::Image();
+
 	juce::Rectangle<int> rectangle;
 
 	// Sliders + Labels
@@ -160,9 +335,18 @@ void MultibandMSAudioProcessorEditor::resized()
 		rectangle.removeFromBottom(labelOffset);
 		m_labels[i].setBounds(rectangle);
 
-		m_labels[i].setFont(juce::Font(fonthHeight, juce::Font::bold));
+		if (fontChanged)
+			m_labels[i].setFont(juce::Font(fonthHeight, juce::Font::bold));
 	}
 
+	// Meters sit inside the rotary rings of the width and volume sliders
+	for (int band = 0; band < N_BANDS; ++band)
+		m_meters[band].setBounds(getMeterBounds(m_sliders[2 * band].getBounds()));
+
+	m_outputMeter.setBounds(getMeterBounds(m_sliders[N_SLIDERS - 1].getBounds()));
+
+	m_analyzer.setBounds(getAnalyzerBounds());
+
 	//Plugin and developer name
 	const int labelHeight = (int)(0.5f * (height - widthSlider));
 	const float logoFonthHeight = fonthHeight * 0.85f;
@@ -170,12 +354,138 @@ void MultibandMSAudioProcessorEditor::resized()
 	rectangle.setPosition((int)(0.5f * widthSlider), 0);
 	rectangle.setSize(widthSlider, labelHeight);
 	m_pluginName.setBounds(rectangle);
-	m_pluginName.setColour(juce::Label::textColourId, ZazzLookAndFeel::mediumColour);
-	m_pluginName.setFont(juce::Font(logoFonthHeight, juce::Font::bold));
+
+	rectangle.setPosition((int)(width - 1.5f * widthSlider), 0);
+	rectangle.setSize(widthSlider, labelHeight);
+	rectangle.reduce((int)(0.15f * widthSlider), 0);
+	m_slope.setBounds(rectangle);
+
+	// Toggle, store A, morph, store B between the plugin name and the slope
+	rectangle.setPosition((int)(1.5f * widthSlider), 0);
+	rectangle.setSize((int)(width - 3.0f * widthSlider), labelHeight);
+	rectangle.reduce((int)(0.15f * widthSlider), 0);
+	m_compare.setBounds(rectangle.removeFromLeft((int)(0.5f * widthSlider)));
+	m_storeSnapshot[0].setBounds(rectangle.removeFromLeft((int)(0.3f * widthSlider)));
+	m_storeSnapshot[1].setBounds(rectangle.removeFromRight((int)(0.3f * widthSlider)));
+	m_morph.setBounds(rectangle.reduced((int)(0.05f * widthSlider), 0));
+
+	rectangle.setPosition((int)(0.5f * widthSlider), (int)(0.95f * labelHeight + widthSlider));
+	rectangle.setSize(widthSlider, labelHeight);
+	rectangle.reduce((int)(0.15f * widthSlider), 0);
+	m_phase.setBounds(rectangle);
+
+	rectangle.setPosition((int)(0.5f * (width - widthSlider)), (int)(0.95f * labelHeight + widthSlider));
+	rectangle.setSize(widthSlider, labelHeight);
+	rectangle.reduce((int)(0.15f * widthSlider), 0);
+	m_oversampling.setBounds(rectangle);
 
 	rectangle.setPosition((int)(width - 1.5f * widthSlider), (int)(0.95f * labelHeight + widthSlider));
 	rectangle.setSize(widthSlider, labelHeight);
 	m_developerName.setBounds(rectangle);
-	m_developerName.setColour(juce::Label::textColourId, ZazzLookAndFeel::mediumColour);
-	m_developerName.setFont(juce::Font(logoFonthHeight, juce::Font::bold));
-}
\ No newline at end of file
+
+	if (fontChanged)
+	{
+		m_pluginName.setFont(juce::Font(logoFonthHeight, juce::Font::bold));
+		m_developerName.setFont(juce::Font(logoFonthHeight, juce::Font::bold));
+	}
+}
+
+void MultibandMSAudioProcessorEditor::timerCallback()
+{
+	m_analyzer.update();
+
+	if (!audioProcessor.getMeterBridge().read(m_meterSnapshot))
+		return;
+
+	for (int band = 0; band < N_BANDS; ++band)
+	{
+		const auto& levels = m_meterSnapshot.band[band];
+		m_meters[band].setLevels(levels.midRms, levels.sideRms, levels.peak, levels.correlation);
+	}
+
+	// Output meter shows left and right peaks in place of mid and side
+	const float peak = juce::jmax(m_meterSnapshot.outputPeak[0], m_meterSnapshot.outputPeak[1]);
+	m_outputMeter.setLevels(m_meterSnapshot.outputPeak[0], m_meterSnapshot.outputPeak[1], peak, 0.0f);
+}
+
+juce::Rectangle<int> MultibandMSAudioProcessorEditor::getMeterBounds(juce::Rectangle<int> slider)
+{
+	// The ring is centred above the text box
+	const int size = slider.getWidth();
+	return slider.withTrimmedBottom(SLIDER_FONT_SIZE).withSizeKeepingCentre((int)(0.44f * size), (int)(0.26f * size));
+}
+
+juce::Rectangle<int> MultibandMSAudioProcessorEditor::getAnalyzerBounds()
+{
+	// Below the bottom banner, inset like the banners
+	const int controlsHeight = getControlsHeight();
+	const int heightLogo = (int)(controlsHeight * ((float)LOGO_HEIGHT / (float)(SLIDER_WIDTH + 2 * LOGO_HEIGHT)));
+	const int removePixels = (int)(heightLogo * 0.48f);
+
+	return juce::Rectangle<int>(0, controlsHeight, getWidth(), getHeight() - controlsHeight).reduced(removePixels);
+}
+
+//==============================================================================
+void LevelMeter::setLevels(float mid, float side, float peak, float correlation)
+{
+	// Bars fall back smoothly, rises show at once
+	mid = juce::jmax(mid, m_mid * DECAY);
+	side = juce::jmax(side, m_side * DECAY);
+	peak = juce::jmax(peak, m_peak * DECAY);
+
+	// Nothing to redraw once everything sits below the floor, e.g. on silence
+	const bool changed = correlation != m_correlation
+		|| toProportion(mid) != toProportion(m_mid)
+		|| toProportion(side) != toProportion(m_side)
+		|| toProportion(peak) != toProportion(m_peak);
+
+	m_mid = mid;
+	m_side = side;
+	m_peak = peak;
+	m_correlation = correlation;
+
+	if (changed)
+		repaint();
+}
+
+float LevelMeter::toProportion(float gain)
+{
+	const float db = juce::Decibels::gainToDecibels(gain, FLOOR_DB);
+	return juce::jlimit(0.0f, 1.0f, (db - FLOOR_DB) / -FLOOR_DB);
+}
+
+void LevelMeter::paint(juce::Graphics& g)
+{
+	const auto bounds = getLocalBounds().toFloat();
+	const float barHeight = bounds.getHeight() * 0.28f;
+	const float gap = bounds.getHeight() * 0.08f;
+	const float width = bounds.getWidth();
+
+	juce::Rectangle<float> mid(bounds.getX(), bounds.getY(), width, barHeight);
+	juce::Rectangle<float> side = mid.translated(0.0f, barHeight + gap);
+	juce::Rectangle<float> correlation = side.translated(0.0f, barHeight + gap).withHeight(bounds.getBottom() - side.getBottom() - gap);
+
+	g.setColour(ZazzLookAndFeel::darkColour);
+	g.fillRect(mid);
+	g.fillRect(side);
+
+	if (m_showCorrelation)
+		g.fillRect(correlation);
+
+	g.setColour(ZazzLookAndFeel::lightColour);
+	g.fillRect(mid.withWidth(width * toProportion(m_mid)));
+	g.fillRect(side.withWidth(width * toProportion(m_side)));
+
+	// Peak tick across both bars, red once it clips
+	const float peakX = bounds.getX() + width * toProportion(m_peak);
+	g.setColour(m_peak >= 1.0f ? juce::Colours::red : ZazzLookAndFeel::lightColour);
+	g.fillRect(juce::Rectangle<float>(peakX - 1.0f, mid.getY(), 2.0f, side.getBottom() - mid.getY()));
+
+	if (!m_showCorrelation)
+		return;
+
+	// Correlation marker, centre is 0
+	const float correlationX = correlation.getCentreX() + 0.5f * width * juce::jlimit(-1.0f, 1.0f, m_correlation);
+	g.setColour(m_correlation < 0.0f ? juce::Colours::red : ZazzLookAndFeel::lightColour);
+	g.fillRect(juce::Rectangle<float>(correlationX - 1.5f, correlation.getY(), 3.0f, correlation.getHeight()));
+}
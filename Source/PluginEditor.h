@@ -19,6 +19,22 @@ public:
 	ZazzLookAndFeel()
 	{
 		setColour(juce::Slider::thumbColourId, juce::Colours::red);
+
+		setColour(juce::ComboBox::backgroundColourId, lightColour);
+		setColour(juce::ComboBox::textColourId, mediumColour);
+		setColour(juce::ComboBox::outlineColourId, lightColour);
+		setColour(juce::ComboBox::arrowColourId, mediumColour);
+		setColour(juce::PopupMenu::backgroundColourId, lightColour);
+		setColour(juce::PopupMenu::textColourId, mediumColour);
+		setColour(juce::PopupMenu::highlightedBackgroundColourId, mediumColour);
+		setColour(juce::PopupMenu::highlightedTextColourId, lightColour);
+
+		setColour(juce::TextButton::buttonColourId, lightColour);
+		setColour(juce::TextButton::buttonOnColourId, mediumColour);
+		setColour(juce::TextButton::textColourOffId, mediumColour);
+		setColour(juce::TextButton::textColourOnId, lightColour);
+		setColour(juce::Slider::backgroundColourId, mediumColour);
+		setColour(juce::Slider::trackColourId, mediumColour);
 	}
 
 	static const juce::Colour lightColour;
@@ -28,33 +44,7 @@ public:
 	static const int SCALE = 70;
 	static const int FONT_SIZE = 24;
 
-	void drawRotarySlider(juce::Graphics& g, int x, int y, int width, int height, float sliderPos, const float rotaryStartAngle, const float rotaryEndAngle, juce::Slider&) override
-	{
-		auto radius = ((float)juce::jmin(width / 2, height / 2) - 4.0f) * 0.9f;
-		auto centreX = (float)x + (float)width  * 0.5f;
-		auto centreY = (float)y + (float)height * 0.5f;
-		auto rx = centreX - radius;
-		auto ry = centreY - radius;
-		auto rw = radius * 2.0f;
-		auto angle = rotaryStartAngle + sliderPos * (rotaryEndAngle - rotaryStartAngle);
-
-		// outline
-		//const float lineThickness = 6.0f;
-		const float lineThickness = height / 28.0f;
-		
-		g.setColour(mediumColour);
-		g.drawEllipse(rx, ry, rw, rw, lineThickness);
-
-		juce::Path p;
-		auto pointerLength = radius * 0.2f;
-		auto pointerThickness = lineThickness;
-		p.addRectangle(-pointerThickness * 0.5f, -radius, pointerThickness, pointerLength);
-		p.applyTransform(juce::AffineTransform::rotation(angle).translated(centreX, centreY));
-
-		// pointer
-		g.setColour(mediumColour);
-		g.fillPath(p);
-	}
+	void drawRotarySlider(juce::Graphics& g, int x, int y, int width, int height, float sliderPos, const float rotaryStartAngle, const float rotaryEndAngle, juce::Slider&) override;
 
 	juce::Label *createSliderTextBox(juce::Slider &) override
 	{
@@ -71,10 +61,51 @@ public:
 		g.setColour(backgroundColour);
 		g.fillRect(buttonArea);
 	}
+
+private:
+	// Ring image and pointer path of one rotary size, rebuilt only when the size or the display scale changes
+	struct RotaryCache
+	{
+		int width = 0;
+		int height = 0;
+		float scale = 0.0f;
+		juce::Image ring;
+		juce::Path pointer;
+	};
+
+	// Full size sliders and the smaller frequency ones
+	static const int N_ROTARY_CACHES = 2;
+
+	RotaryCache& getRotaryCache(int width, int height, float scale);
+
+	RotaryCache m_rotaryCache[N_ROTARY_CACHES];
+	int m_nextRotaryCache = 0;
+};
+
+//==============================================================================
+// Mid and side RMS bars with a peak tick, over a correlation scale from -1 to 1
+class LevelMeter : public juce::Component
+{
+public:
+	void setLevels(float mid, float side, float peak, float correlation);
+	void setShowCorrelation(bool show) { m_showCorrelation = show; }
+	void paint(juce::Graphics& g) override;
+
+private:
+	static constexpr float FLOOR_DB = -60.0f;
+	static constexpr float DECAY = 0.85f; // per update, about 30 Hz
+
+	static float toProportion(float gain);
+
+	float m_mid = 0.0f;
+	float m_side = 0.0f;
+	float m_peak = 0.0f;
+	float m_correlation = 0.0f;
+	bool m_showCorrelation = true;
 };
 
 //==============================================================================
-class MultibandMSAudioProcessorEditor : public juce::AudioProcessorEditor
+class MultibandMSAudioProcessorEditor : public juce::AudioProcessorEditor, private juce::Timer
 {
 public:
     MultibandMSAudioProcessorEditor (MultibandMSAudioProcessor&, juce::AudioProcessorValueTreeState&);
@@ -82,7 +113,10 @@ public:
 
 	// GUI setup
 	static const int N_SLIDERS = 6;
+	static const int N_BANDS = MultibandMSAudioProcessor::N_BANDS;
+	static const int METER_RATE = 30;
 	static const int LOGO_HEIGHT = 20;
+	static const int ANALYZER_HEIGHT = 110;
 	static const int SLIDER_WIDTH = 140;
 	static const int SLIDER_FONT_SIZE = 20;
 	static const int FONT_DIVISOR = 10;	
@@ -92,10 +126,20 @@ public:
 
 	typedef juce::AudioProcessorValueTreeState::SliderAttachment SliderAttachment;
 	typedef juce::AudioProcessorValueTreeState::ComboBoxAttachment ComboBoxAttachment;
+	typedef juce::AudioProcessorValueTreeState::ButtonAttachment ButtonAttachment;
 
 private:
 	inline int getSliderWidth() { return (int)(getWidth() / 5.6f); }
 
+	// Height of the logo banners and sliders, the analyzer takes the rest
+	inline int getControlsHeight() { return (int)(getHeight() * ((float)(SLIDER_WIDTH + 2 * LOGO_HEIGHT) / (float)(SLIDER_WIDTH + 2 * LOGO_HEIGHT + ANALYZER_HEIGHT))); }
+	juce::Rectangle<int> getAnalyzerBounds();
+
+	void drawBackground(juce::Graphics& g);
+
+	void timerCallback() override;
+	juce::Rectangle<int> getMeterBounds(juce::Rectangle<int> slider);
+
     MultibandMSAudioProcessor& audioProcessor;
 
 	ZazzLookAndFeel zazzLookAndFeel;
@@ -106,8 +150,35 @@ private:
 	juce::Slider m_sliders[N_SLIDERS] = {};
 	std::unique_ptr<SliderAttachment> m_sliderAttachment[N_SLIDERS] = {};
 
+	juce::ComboBox m_slope;
+	std::unique_ptr<ComboBoxAttachment> m_slopeAttachment;
+	juce::ComboBox m_phase;
+	std::unique_ptr<ComboBoxAttachment> m_phaseAttachment;
+	juce::ComboBox m_oversampling;
+	std::unique_ptr<ComboBoxAttachment> m_oversamplingAttachment;
+
+	// A/B compare in the top banner: the toggle hands the sound to the morph between the
+	// snapshots, A and B store the knobs into them
+	juce::TextButton m_compare{ "A/B" };
+	std::unique_ptr<ButtonAttachment> m_compareAttachment;
+	juce::TextButton m_storeSnapshot[2] = { juce::TextButton("A"), juce::TextButton("B") };
+	juce::Slider m_morph;
+	std::unique_ptr<SliderAttachment> m_morphAttachment;
+
+	// On the width sliders, and the output peaks on the volume slider
+	LevelMeter m_meters[N_BANDS];
+	LevelMeter m_outputMeter;
+	MeterSnapshot m_meterSnapshot;
+
+	AnalyzerView m_analyzer;
+
 	juce::Label m_pluginName;
 	juce::Label m_developerName;
 
+	// Banners drawn once per size and display scale, paint only blits them
+	juce::Image m_background;
+	float m_backgroundScale = 0.0f;
+	float m_fontHeight = 0.0f;
+
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (MultibandMSAudioProcessorEditor)
 };
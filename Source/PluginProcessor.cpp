@@ -10,149 +10,14 @@
 #include "PluginEditor.h"
 
 //==============================================================================
-FirstOrderAllPass::FirstOrderAllPass()
-{
-}
-
-void FirstOrderAllPass::init(int sampleRate)
-{
-	m_SampleRate = sampleRate;
-}
-
-void FirstOrderAllPass::setFrequency(float frequency)
-{
-	if (m_SampleRate == 0)
-	{
-		return;
-	}
-
-	const float pi = 3.141592653589793f;
-
-	const float tmp = tanf(pi * frequency / m_SampleRate);
-	m_a1 = (tmp - 1.0f) / (tmp + 1.0f);
-}
-
-void FirstOrderAllPass::setCoef(float coef)
-{
-	m_a1 = coef;
-}
-
-float FirstOrderAllPass::process(float in)
-{
-	const float tmp = m_a1 * in + m_d;
-	m_d = in - m_a1 * tmp;
-	return tmp;
-}
-
-//==============================================================================
-SecondOrderAllPass::SecondOrderAllPass()
-{
-}
-
-void SecondOrderAllPass::init(int sampleRate)
-{
-	m_SampleRate = sampleRate;
-}
-
-void SecondOrderAllPass::setFrequency(float frequency, float Q)
-{
-	if (m_SampleRate == 0)
-	{
-		return;
-	}
-
-	const float pi = 3.141592653589793f;
-
-	const float w = 2.0f * pi * frequency / m_SampleRate;
-	const float cosw = cos(w);
-	const float alpha = sin(w) * (2.0f * Q);
-
-	const float a2 = 1 + alpha;
-
-	m_a0 = (1.0f - alpha) / a2;
-	m_a1 = (-2.0f * cosw) / a2;
-}
 
-float SecondOrderAllPass::process(float in)
-{
-	const float y0 = m_a0 * (in - m_y2) + m_a1 * (m_x1 - m_y1) + m_x2;
+const std::string MultibandMSAudioProcessor::paramsNames[] = { "Low", "FreqLM", "Mid", "FreqMH", "High", "Volume", "Slope", "Phase", "Oversampling", "Compare", "Morph" };
+const juce::StringArray MultibandMSAudioProcessor::slopeNames = { "12 dB", "24 dB", "48 dB" };
+const juce::StringArray MultibandMSAudioProcessor::phaseNames = { "Natural", "Linear" };
+const juce::StringArray MultibandMSAudioProcessor::oversamplingNames = { "1x", "2x", "4x" };
 
-	m_x2 = m_x1;
-	m_x1 = in;
-	m_y2 = m_y1;
-	m_y1 = y0;
-
-	return y0;
-}
-
-//==============================================================================
-LinkwitzRileySecondOrder::LinkwitzRileySecondOrder()
-{
-}
-
-void LinkwitzRileySecondOrder::init(int sampleRate)
-{
-	m_SampleRate = sampleRate;
-}
-
-void LinkwitzRileySecondOrder::setFrequency(float frequency)
-{
-	if (m_SampleRate == 0)
-	{
-		return;
-	}
-
-	const float pi = 3.141592653589793f;
-
-	const float fpi = pi * frequency;
-	const float wc = 2.0f * fpi;
-	const float wc2 = wc * wc;
-	const float wc22 = 2.0f * wc2;
-	const float k = wc / tanf(fpi / m_SampleRate);
-	const float k2 = k * k;
-	const float k22 = 2 * k2;
-	const float wck2 = 2 * wc * k;
-	const float tmpk = k2 + wc2 + wck2;
-	
-	m_b1 = (-k22 + wc22) / tmpk;
-	m_b2 = (-wck2 + k2 + wc2) / tmpk;
-	
-	//---------------
-	// low-pass
-	//---------------
-	m_a0_lp = wc2 / tmpk;
-	m_a1_lp = wc22 / tmpk;
-	m_a2_lp = wc2 / tmpk;
-	
-	//----------------
-	// high-pass
-	//----------------
-	m_a0_hp = k2 / tmpk;
-	m_a1_hp = -k22 / tmpk;
-	m_a2_hp = k2 / tmpk;	
-}
-
-float LinkwitzRileySecondOrder::processLP(float in)
-{
-	const float y0 = m_a0_lp * in + m_x0_lp;
-	m_x0_lp = m_a1_lp * in - m_b1 * y0 + m_x1_lp;
-	m_x1_lp = m_a2_lp * in - m_b2 * y0;
-
-	return y0;
-}
-
-float LinkwitzRileySecondOrder::processHP(float in)
-{
-	const float y0 = m_a0_hp * in + m_x0_hp;
-	m_x0_hp = m_a1_hp * in - m_b1 * y0 + m_x1_hp;
-	m_x1_hp = m_a2_hp * in - m_b2 * y0;
-
-	return -y0;
-}
-
-//==============================================================================
-
-const std::string MultibandMSAudioProcessor::paramsNames[] = { "Low", "FreqLM", "Mid", "FreqMH", "High", "Volume" };
+static_assert(sizeof(MultibandMSAudioProcessor::paramsNames) / sizeof(MultibandMSAudioProcessor::paramsNames[0]) == MultibandMSAudioProcessor::N_PARAMETERS,
+              "N_PARAMETERS must match paramsNames");
 
 //==============================================================================
 MultibandMSAudioProcessor::MultibandMSAudioProcessor()
@@ -163,6 +28,14 @@ MultibandMSAudioProcessor::MultibandMSAudioProcessor()
                        .withInput  ("Input",  juce::AudioChannelSet::stereo(), true)
                       #endif
                        .withOutput ("Output", juce::AudioChannelSet::stereo(), true)
+                      #if ! JucePlugin_IsSynth
+                       .withInput  ("Stem 2", juce::AudioChannelSet::stereo(), false)
+                       .withOutput ("Stem 2", juce::AudioChannelSet::stereo(), false)
+                       .withInput  ("Stem 3", juce::AudioChannelSet::stereo(), false)
+                       .withOutput ("Stem 3", juce::AudioChannelSet::stereo(), false)
+                       .withInput  ("Stem 4", juce::AudioChannelSet::stereo(), false)
+                       .withOutput ("Stem 4", juce::AudioChannelSet::stereo(), false)
+                      #endif
                      #endif
                        )
 #endif
@@ -173,6 +46,14 @@ MultibandMSAudioProcessor::MultibandMSAudioProcessor()
 	frequencyMidHighParameter = apvts.getRawParameterValue(paramsNames[3]);
 	widthHighParameter        = apvts.getRawParameterValue(paramsNames[4]);
 	volumeParameter           = apvts.getRawParameterValue(paramsNames[5]);
+	slopeParameter            = apvts.getRawParameterValue(paramsNames[6]);
+	phaseParameter            = apvts.getRawParameterValue(paramsNames[7]);
+	oversamplingParameter     = apvts.getRawParameterValue(paramsNames[8]);
+	compareParameter          = apvts.getRawParameterValue(paramsNames[9]);
+	morphParameter            = apvts.getRawParameterValue(paramsNames[10]);
+
+	for (int index = 0; index < N_PARAMETERS; ++index)
+		m_parameters[index] = apvts.getParameter(paramsNames[index]);
 }
 
 MultibandMSAudioProcessor::~MultibandMSAudioProcessor()
@@ -214,43 +95,74 @@ bool MultibandMSAudioProcessor::isMidiEffect() const
 
 double MultibandMSAudioProcessor::getTailLengthSeconds() const
 {
+	const double sampleRate = getSampleRate();
+
+	if (sampleRate > 0.0)
+		return (double)m_engine.getTailSamples() / sampleRate;
+
     return 0.0;
 }
 
 int MultibandMSAudioProcessor::getNumPrograms()
 {
-    return 1;   // NB: some hosts don't cope very well if you tell them there are 0 programs,
-                // so this should be at least 1, even if you're not really implementing programs.
+	return PresetBank::N_PRESETS;
 }
 
 int MultibandMSAudioProcessor::getCurrentProgram()
 {
-    return 0;
+	return m_currentProgram;
 }
 
 void MultibandMSAudioProcessor::setCurrentProgram (int index)
 {
+	if (index < 0 || index >= PresetBank::N_PRESETS)
+		return;
+
+	// Through the parameters, so the audio thread glides to the preset like to any automation
+	m_currentProgram = index;
+	setContinuousValues(PresetBank::presets[index].values);
 }
 
 const juce::String MultibandMSAudioProcessor::getProgramName (int index)
 {
-    return {};
+	if (index < 0 || index >= PresetBank::N_PRESETS)
+		return {};
+
+	return PresetBank::presets[index].name;
 }
 
 void MultibandMSAudioProcessor::changeProgramName (int index, const juce::String& newName)
 {
 }
 
+void MultibandMSAudioProcessor::storeSnapshot(int slot)
+{
+	float values[PresetBank::N_VALUES];
+	for (int index = 0; index < PresetBank::N_VALUES; ++index)
+		values[index] = m_parameters[index]->convertFrom0to1(m_parameters[index]->getValue());
+
+	m_presetBank.store(slot, values);
+}
+
+void MultibandMSAudioProcessor::setContinuousValues(const float* values)
+{
+	for (int index = 0; index < PresetBank::N_VALUES; ++index)
+	{
+		auto* parameter = m_parameters[index];
+		parameter->beginChangeGesture();
+		parameter->setValueNotifyingHost(parameter->convertTo0to1(values[index]));
+		parameter->endChangeGesture();
+	}
+}
+
 //==============================================================================
 void MultibandMSAudioProcessor::prepareToPlay (double sampleRate, int samplesPerBlock)
 {
-	int sr = (int)(sampleRate);
-	m_lowMidFilter[0].init(sr);
-	m_lowMidFilter[1].init(sr);
-	m_midHighFilter[0].init(sr);
-	m_midHighFilter[1].init(sr);
-	m_allPassFilter[0].init(sr);
-	m_allPassFilter[1].init(sr);
+	updateChannelPairs();
+
+	m_engine.prepare(sampleRate, samplesPerBlock, m_layoutChannels, m_pairs, readParameters());
+	m_engine.setMetering(true);
+	setLatencySamples(m_engine.getLatency());
 }
 
 void MultibandMSAudioProcessor::releaseResources()
@@ -265,18 +177,23 @@ bool MultibandMSAudioProcessor::isBusesLayoutSupported (const BusesLayout& layou
     juce::ignoreUnused (layouts);
     return true;
   #else
-    // This is the place where you check if the layout is supported.
-    // In this template code we only support mono or stereo.
-    // Some plugin hosts, such as certain GarageBand versions, will only
-    // load plugins that support stereo bus layouts.
-    if (layouts.getMainOutputChannelSet() != juce::AudioChannelSet::mono()
-     && layouts.getMainOutputChannelSet() != juce::AudioChannelSet::stereo())
-        return false;
+	// The main bus takes anything from mono to 7.1, its stereo pairs go through the stereo
+	// kernel and the other channels through the mono one. Stem buses are stereo or disabled.
+	const auto& main = layouts.getMainOutputChannelSet();
+	if (main.isDisabled() || main.size() > MAX_MAIN_CHANNELS)
+		return false;
+
+	for (int bus = 1; bus < layouts.outputBuses.size(); ++bus)
+	{
+		const auto& stem = layouts.getChannelSet(false, bus);
+		if (!stem.isDisabled() && stem != juce::AudioChannelSet::stereo())
+			return false;
+	}
 
     // This checks if the input layout matches the output layout
    #if ! JucePlugin_IsSynth
-    if (layouts.getMainOutputChannelSet() != layouts.getMainInputChannelSet())
-        return false;
+	if (layouts.inputBuses != layouts.outputBuses)
+		return false;
    #endif
 
     return true;
@@ -284,91 +201,150 @@ bool MultibandMSAudioProcessor::isBusesLayoutSupported (const BusesLayout& layou
 }
 #endif
 
+void MultibandMSAudioProcessor::updateChannelPairs()
+{
+	m_pairs.clear();
+
+	// Buses follow each other in the process buffer
+	int offset = 0;
+
+	for (const auto& set : getBusesLayout().outputBuses)
+	{
+		addChannelPairs(m_pairs, set, offset);
+		offset += set.size();
+	}
+
+	m_layoutChannels = offset;
+}
+
+bool MultibandMSAudioProcessor::supportsDoublePrecisionProcessing() const
+{
+	return true;
+}
+
+// FTZ/DAZ for the whole block, covering the oversampling filters as well as the crossovers
 void MultibandMSAudioProcessor::processBlock (juce::AudioBuffer<float>& buffer, juce::MidiBuffer& midiMessages)
 {
-	const int channels = getTotalNumOutputChannels();
-	if (channels != 2)
+	juce::ScopedNoDenormals noDenormals;
+	processSamples(buffer);
+}
+
+void MultibandMSAudioProcessor::processBlock (juce::AudioBuffer<double>& buffer, juce::MidiBuffer& midiMessages)
+{
+	juce::ScopedNoDenormals noDenormals;
+	processSamples(buffer);
+}
+
+void MultibandMSAudioProcessor::processBlockBypassed (juce::AudioBuffer<float>& buffer, juce::MidiBuffer& midiMessages)
+{
+	bypassSamples(buffer);
+}
+
+void MultibandMSAudioProcessor::processBlockBypassed (juce::AudioBuffer<double>& buffer, juce::MidiBuffer& midiMessages)
+{
+	bypassSamples(buffer);
+}
+
+template <typename SampleType>
+void MultibandMSAudioProcessor::bypassSamples(juce::AudioBuffer<SampleType>& buffer)
+{
+	jassert(buffer.getNumChannels() >= m_layoutChannels);
+	if (buffer.getNumChannels() < m_layoutChannels)
 		return;
 
-	// Get params
-	const auto widthLow = widthLowParameter->load();
-	const auto frequencyLowMid = frequencyLowMidParameter->load();
-	const auto widthMid = widthMidParameter->load();
-	const auto frequencyMidHigh = frequencyMidHighParameter->load();
-	const auto widthHigh = widthHighParameter->load();
-	const auto volume = juce::Decibels::decibelsToGain(volumeParameter->load());
+	// The latency keeps following the parameters, so hosts compensate the same whether bypassed or not
+	m_engine.processBypassed(buffer.getArrayOfWritePointers(), buffer.getNumSamples(), readParameters());
+	setLatencySamples(m_engine.getLatency());
+}
 
-	// Mics constants
+template <typename SampleType>
+void MultibandMSAudioProcessor::processSamples(juce::AudioBuffer<SampleType>& buffer)
+{
 	const int samples = buffer.getNumSamples();
 
-	// Left channel
-	auto* channelBufferLeft = buffer.getWritePointer(0);
-	auto& lowMidFilterLeft = m_lowMidFilter[0];
-	auto& midHighFilterLeft = m_midHighFilter[0];
-	auto& allPassFilterLeft = m_allPassFilter[0];
+	jassert(buffer.getNumChannels() >= m_layoutChannels && m_layoutChannels <= MAX_LAYOUT_CHANNELS);
+	if (samples == 0 || buffer.getNumChannels() < m_layoutChannels || m_layoutChannels > MAX_LAYOUT_CHANNELS)
+		return;
+
+	// Large host blocks go through the engine in slices, with the continuous parameters read again for
+	// each, so automation resolution does not depend on the host block size
+	auto* const* bufferChannels = buffer.getArrayOfWritePointers();
+	SampleType* channels[MAX_LAYOUT_CHANNELS];
 
-	lowMidFilterLeft.setFrequency(frequencyLowMid);
-	midHighFilterLeft.setFrequency(frequencyMidHigh);
-	allPassFilterLeft.setFrequency(frequencyMidHigh);
+	for (int offset = 0; offset < samples; offset += MultibandEngine::AUTOMATION_BLOCK_SIZE)
+	{
+		for (int channel = 0; channel < m_layoutChannels; ++channel)
+			channels[channel] = bufferChannels[channel] + offset;
 
-	// Right channel
-	auto* channelBufferRight = buffer.getWritePointer(1);
-	auto& lowMidFilterRight = m_lowMidFilter[1];
-	auto& midHighFilterRight = m_midHighFilter[1];
-	auto& allPassFilterRight = m_allPassFilter[1];
+		m_engine.process(channels, juce::jmin(MultibandEngine::AUTOMATION_BLOCK_SIZE, samples - offset), readParameters());
+	}
 
-	lowMidFilterRight.setFrequency(frequencyLowMid);
-	midHighFilterRight.setFrequency(frequencyMidHigh);
-	allPassFilterRight.setFrequency(frequencyMidHigh);
+	setLatencySamples(m_engine.getLatency());
+
+	if (m_pairs.empty())
+		return;
 
-	for (int sample = 0; sample < samples; ++sample)
+	// The editor meters the front pair, a mono front shows as both sides
+	const auto& front = m_pairs.front();
+	const int frontRight = front.isMono() ? front.left : front.right;
+	auto& meters = m_engine.getMeters();
+	meters.addOutputPeak((float)buffer.getMagnitude(front.left, 0, samples), (float)buffer.getMagnitude(frontRight, 0, samples));
+	meters.publishIfDue(m_meterBridge);
+
+	AnalyzerStatus status;
+	status.sampleRate = getSampleRate();
+	m_engine.getCurrentFrequencies(status.frequencies);
+	m_analyzerFifo.push(buffer.getReadPointer(front.left), buffer.getReadPointer(frontRight), samples, status);
+}
+
+const ParameterSnapshot& MultibandMSAudioProcessor::readParameters()
+{
+	float raw[N_STATE_VALUES] = { widthLowParameter->load(), frequencyLowMidParameter->load(), widthMidParameter->load(),
+	                              frequencyMidHighParameter->load(), widthHighParameter->load(), volumeParameter->load(),
+	                              slopeParameter->load(), phaseParameter->load(), oversamplingParameter->load(),
+	                              compareParameter->load(), morphParameter->load() };
+
+	// While comparing, the A/B morph stands in for the knobs, so edited snapshots count as changes too
+	const bool comparing = raw[9] >= 0.5f;
+	if (comparing)
+		for (int slot = 0; slot < PresetBank::N_SLOTS; ++slot)
+			m_presetBank.get(slot, raw + N_PARAMETERS + slot * PresetBank::N_VALUES);
+
+	if (m_snapshotValid && std::equal(raw, raw + N_STATE_VALUES, m_rawValues))
+		return m_snapshot;
+
+	std::copy(raw, raw + N_STATE_VALUES, m_rawValues);
+	m_snapshotValid = true;
+
+	ParameterSnapshot snapshot;
+
+	snapshot.width[0] = raw[0];
+	snapshot.frequency[0] = raw[1];
+	snapshot.width[1] = raw[2];
+	snapshot.frequency[1] = raw[3];
+	snapshot.width[2] = raw[4];
+	snapshot.volume = raw[5];
+	snapshot.slope = juce::jlimit(0, slopeNames.size() - 1, (int)raw[6]);
+	snapshot.linearPhase = raw[7] >= 0.5f;
+	snapshot.oversampling = juce::jlimit(0, MultibandEngine::MAX_OVERSAMPLING, (int)raw[8]);
+
+	if (comparing)
 	{
-		// Process left channel
-		const float inLeft = channelBufferLeft[sample];
-
-		const float lowLeft = lowMidFilterLeft.processLP(inLeft);
-		const float midHighLeft = lowMidFilterLeft.processHP(inLeft);
-		float midLeft = midHighFilterLeft.processLP(midHighLeft);
-		float highLeft = midHighFilterLeft.processHP(midHighLeft);
-		float lowLeftAllPass = allPassFilterLeft.process(lowLeft);
-
-		// Process right channel
-		const float inRight = channelBufferRight[sample];
-
-		const float lowRight = lowMidFilterRight.processLP(inRight);
-		const float midHighRight = lowMidFilterRight.processHP(inRight);
-		float midRight = midHighFilterRight.processLP(midHighRight);
-		float highRight = midHighFilterRight.processHP(midHighRight);
-		float lowRightAllPass = allPassFilterRight.process(lowRight);
-
-		// MS encoding
-		const float midAttenuation = 1.0f - juce::Decibels::decibelsToGain(-8.0f);
-		const float lowMidFactor = (widthLow < 1.0f) ? 1.0f + (1.0f - widthLow) * 0.5f : 1.0f - (midAttenuation * (widthLow - 1.0f));
-		const float lowSideFactor = widthLow;
-		const float midMidFactor = (widthMid < 1.0f) ? 1.0f + (1.0f - widthMid) * 0.5f : 1.0f - (midAttenuation * (widthMid - 1.0f));
-		const float midSideFactor = widthMid;
-		const float highMidFactor = (widthHigh < 1.0f) ? 1.0f + (1.0f - widthHigh) * 0.5f : 1.0f - (midAttenuation * (widthHigh - 1.0f));
-		const float highSideFactor = widthHigh;
-
-		const float lowMid = lowMidFactor * (lowLeftAllPass + lowRightAllPass);
-		const float lowSide = lowSideFactor * (lowLeftAllPass - lowRightAllPass);
-		const float midMid = midMidFactor * (midLeft + midRight);
-		const float midSide = midSideFactor * (midLeft - midRight);
-		const float highMid = highMidFactor * (highLeft + highRight);
-		const float highSide = highSideFactor * (highLeft - highRight);
-
-		// MS decoder
-		lowLeftAllPass = lowMid + lowSide;
-		lowRightAllPass = lowMid - lowSide;
-		midLeft = midMid + midSide;
-		midRight = midMid - midSide;
-		highLeft = highMid + highSide;
-		highRight = highMid - highSide;
-
-		// Apply volume, mix and send to output
-		channelBufferLeft[sample] = 0.5f * volume * (lowLeftAllPass + midLeft + highLeft);
-		channelBufferRight[sample] = 0.5f * volume * (lowRightAllPass + midRight + highRight);		
+		float values[PresetBank::N_VALUES];
+		m_presetBank.morph(raw[10], values);
+
+		snapshot.width[0] = values[0];
+		snapshot.frequency[0] = values[1];
+		snapshot.width[1] = values[2];
+		snapshot.frequency[1] = values[3];
+		snapshot.width[2] = values[4];
+		snapshot.volume = values[5];
 	}
+
+	snapshot.update();
+	m_snapshot = snapshot;
+
+	return m_snapshot;
 }
 
 //==============================================================================
@@ -384,14 +360,58 @@ juce::AudioProcessorEditor* MultibandMSAudioProcessor::createEditor()
 
 //==============================================================================
 void MultibandMSAudioProcessor::getStateInformation (juce::MemoryBlock& destData)
-{	
-	auto state = apvts.copyState();
-	std::unique_ptr<juce::XmlElement> xml(state.createXml());
-	copyXmlToBinary(*xml, destData);
+{
+	// Parameters in paramsNames order, then snapshots A and B
+	float values[N_STATE_VALUES];
+	for (int index = 0; index < N_PARAMETERS; ++index)
+		values[index] = m_parameters[index]->convertFrom0to1(m_parameters[index]->getValue());
+
+	for (int slot = 0; slot < PresetBank::N_SLOTS; ++slot)
+		m_presetBank.get(slot, values + N_PARAMETERS + slot * PresetBank::N_VALUES);
+
+	BinaryState::write(values, N_STATE_VALUES, destData);
 }
 
 void MultibandMSAudioProcessor::setStateInformation (const void* data, int sizeInBytes)
 {
+	float values[N_STATE_VALUES];
+	const int count = BinaryState::read(data, sizeInBytes, values, N_STATE_VALUES);
+
+	if (count >= 0)
+	{
+		// Applied in place, parameters the state is too old to know go back to their defaults, and so do
+		// non-finite values of a damaged state, which convertTo0to1 would pass on as NaN
+		for (int index = 0; index < N_PARAMETERS; ++index)
+		{
+			auto* parameter = m_parameters[index];
+			const bool saved = index < count && std::isfinite(values[index]);
+			const float value = saved ? parameter->convertTo0to1(values[index]) : parameter->getDefaultValue();
+
+			if (value != parameter->getValue())
+				parameter->setValueNotifyingHost(value);
+		}
+
+		// Snapshots are only ever read by the morph, so a damaged state is held to the parameter ranges here
+		for (int slot = 0; slot < PresetBank::N_SLOTS; ++slot)
+		{
+			const int first = N_PARAMETERS + slot * PresetBank::N_VALUES;
+			const bool saved = first + PresetBank::N_VALUES <= count;
+			float snapshot[PresetBank::N_VALUES];
+
+			for (int index = 0; index < PresetBank::N_VALUES; ++index)
+			{
+				const float value = saved ? values[first + index] : PresetBank::presets[0].values[index];
+				snapshot[index] = std::isfinite(value) ? m_parameters[index]->getNormalisableRange().getRange().clipValue(value)
+				                                       : PresetBank::presets[0].values[index];
+			}
+
+			m_presetBank.store(slot, snapshot);
+		}
+
+		return;
+	}
+
+	// Sessions saved before the binary format hold the ValueTree as XML
 	std::unique_ptr<juce::XmlElement> xmlState(getXmlFromBinary(data, sizeInBytes));
 
 	if (xmlState.get() != nullptr)
@@ -411,6 +431,11 @@ juce::AudioProcessorValueTreeState::ParameterLayout MultibandMSAudioProcessor::c
 	layout.add(std::make_unique<juce::AudioParameterFloat>(paramsNames[3], paramsNames[3], NormalisableRange<float>( 1760.0f, 7040.0f,  1.0f, 0.4f), 3520.5f));
 	layout.add(std::make_unique<juce::AudioParameterFloat>(paramsNames[4], paramsNames[4], NormalisableRange<float>(    0.0f,    2.0f, 0.01f, 1.0f), 1.0f));
 	layout.add(std::make_unique<juce::AudioParameterFloat>(paramsNames[5], paramsNames[5], NormalisableRange<float>(  -18.0f,   18.0f,  0.1f, 1.0f),    0.0f));
+	layout.add(std::make_unique<juce::AudioParameterChoice>(paramsNames[6], paramsNames[6], slopeNames, 0));
+	layout.add(std::make_unique<juce::AudioParameterChoice>(paramsNames[7], paramsNames[7], phaseNames, 0));
+	layout.add(std::make_unique<juce::AudioParameterChoice>(paramsNames[8], paramsNames[8], oversamplingNames, 0));
+	layout.add(std::make_unique<juce::AudioParameterBool>(paramsNames[9], paramsNames[9], false));
+	layout.add(std::make_unique<juce::AudioParameterFloat>(paramsNames[10], paramsNames[10], NormalisableRange<float>(    0.0f,    1.0f, 0.01f, 1.0f), 0.0f));
 
 	return layout;
 }
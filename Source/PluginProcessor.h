@@ -9,76 +9,10 @@
 #pragma once
 
 #include <JuceHeader.h>
-//==============================================================================
-class FirstOrderAllPass
-{
-public:
-	FirstOrderAllPass();
-
-	void init(int sampleRate);
-	void setFrequency(float frequency);
-	void setCoef(float coef);
-	float process(float in);
-
-protected:
-	float m_SampleRate;
-	float m_a1 = -1.0f; // all pass filter coeficient
-	float m_d = 0.0f;   // history d = x[n-1] - a1y[n-1]
-};
-
-//==============================================================================
-class SecondOrderAllPass
-{
-public:
-	SecondOrderAllPass();
-
-	void init(int sampleRate);
-	void setFrequency(float frequency, float Q);
-	float process(float in);
-
-protected:
-	float m_SampleRate;
-
-	float m_x2 = 0.0f;
-	float m_x1 = 0.0f;
-	float m_y2 = 0.0f;
-	float m_y1 = 0.0f;
-
-	float m_a0 = 0.0f;
-	float m_a1 = 0.0f;
-};
-
-//==============================================================================
-class LinkwitzRileySecondOrder
-{
-public:
-	LinkwitzRileySecondOrder();
-
-	void init(int sampleRate);
-	void setFrequency(float frequency);
-	float processLP(float in);
-	float processHP(float in);
-
-protected:
-	float m_SampleRate;
-	
-	float m_b1 = 0.0f;
-	float m_b2 = 0.0f;
-
-	float m_a0_lp = 0.0f;
-	float m_a1_lp = 0.0f;
-	float m_a2_lp = 0.0f;
-
-	float m_a0_hp = 0.0f;
-	float m_a1_hp = 0.0f;
-	float m_a2_hp = 0.0f;
-
-	float m_x1_lp = 0.0f;
-	float m_x0_lp = 0.0f;
-
-	float m_x1_hp = 0.0f;
-	float m_x0_hp = 0.0f;
-};
+#include "MultibandEngine.h"
+#include "Analyzer.h"
+#include "BinaryState.h"
+#include "PresetBank.h"
 
 //==============================================================================
 class MultibandMSAudioProcessor  : public juce::AudioProcessor
@@ -92,11 +26,17 @@ public:
     MultibandMSAudioProcessor();
     ~MultibandMSAudioProcessor() override;
 
-	static const int N_ALL_PASS_FO = 100;
-	static const int N_ALL_PASS_SO = 50;
 	static const int FREQUENCY_MIN = 20;
 	static const int FREQUENCY_MAX = 20000;
+	static const int N_BANDS = MultibandEngine::N_BANDS;
+	static const int MAX_MAIN_CHANNELS = 8; // up to 7.1 on the main bus
+	static const int N_STEM_BUSES = 3;      // optional stereo buses after the main one
+	static const int MAX_LAYOUT_CHANNELS = MAX_MAIN_CHANNELS + 2 * N_STEM_BUSES;
+	static const int N_PARAMETERS = 11;
 	static const std::string paramsNames[];
+	static const juce::StringArray slopeNames;
+	static const juce::StringArray phaseNames;
+	static const juce::StringArray oversamplingNames;
 
     //==============================================================================
     void prepareToPlay (double sampleRate, int samplesPerBlock) override;
@@ -107,6 +47,10 @@ public:
 #endif
 
     void processBlock (juce::AudioBuffer<float>&, juce::MidiBuffer&) override;
+    void processBlock (juce::AudioBuffer<double>&, juce::MidiBuffer&) override;
+    void processBlockBypassed (juce::AudioBuffer<float>&, juce::MidiBuffer&) override;
+    void processBlockBypassed (juce::AudioBuffer<double>&, juce::MidiBuffer&) override;
+    bool supportsDoublePrecisionProcessing() const override;
 
     //==============================================================================
     juce::AudioProcessorEditor* createEditor() override;
@@ -149,6 +93,18 @@ public:
 		return fn;
 	}
 
+	// Band and output levels for the editor, read from the message thread
+	MeterBridge& getMeterBridge() { return m_meterBridge; }
+
+	// Output samples for the analyzer, filled only while it is open
+	AnalyzerFifo& getAnalyzerFifo() { return m_analyzerFifo; }
+
+	// Forces the crossover kernel from the next prepareToPlay, for tests and benchmarks. Auto by default.
+	void setKernel(SimdKernel kernel) { m_engine.setKernel(kernel); }
+
+	// Message thread, stores the current knob values as snapshot A (0) or B (1) for the Compare morph
+	void storeSnapshot(int slot);
+
 	using APVTS = juce::AudioProcessorValueTreeState;
 	static APVTS::ParameterLayout createParameterLayout();
 
@@ -156,6 +112,17 @@ public:
 
 private:	
 	//==============================================================================
+	// Slices host blocks at the engine automation block size, with the parameters read again for each slice
+	template <typename SampleType>
+	void processSamples(juce::AudioBuffer<SampleType>& buffer);
+	template <typename SampleType>
+	void bypassSamples(juce::AudioBuffer<SampleType>& buffer);
+	void updateChannelPairs();
+
+	// Audio thread, or before processing starts
+	const ParameterSnapshot& readParameters();
+	void setContinuousValues(const float* values);
+
 
 	std::atomic<float>* widthLowParameter = nullptr;
 	std::atomic<float>* frequencyLowMidParameter = nullptr;
@@ -163,10 +130,36 @@ private:
 	std::atomic<float>* frequencyMidHighParameter = nullptr;
 	std::atomic<float>* widthHighParameter = nullptr;
 	std::atomic<float>* volumeParameter = nullptr;
+	std::atomic<float>* slopeParameter = nullptr;
+	std::atomic<float>* phaseParameter = nullptr;
+	std::atomic<float>* oversamplingParameter = nullptr;
+	std::atomic<float>* compareParameter = nullptr;
+	std::atomic<float>* morphParameter = nullptr;
+
+	// In paramsNames order, for state saving and loading without going through the ValueTree
+	juce::RangedAudioParameter* m_parameters[N_PARAMETERS] = {};
+
+	// Saved state holds the parameters, then the A and B snapshots
+	static const int N_STATE_VALUES = N_PARAMETERS + PresetBank::N_SLOTS * PresetBank::N_VALUES;
+
+	PresetBank m_presetBank;
+	int m_currentProgram = 0;
+
+	// Raw values m_snapshot was last built from, laid out as the saved state; the snapshots only while
+	// comparing. Most slices change none of them and skip the rebuild, with its dB and morph maths.
+	float m_rawValues[N_STATE_VALUES] = {};
+	ParameterSnapshot m_snapshot;
+	bool m_snapshotValid = false;
+
+	MultibandEngine m_engine;
+
+	// Stereo pairs of all enabled buses, e.g. front, surround and rear of a 7.1 bed, then the
+	// channels left over, such as centre and LFE, each on its own
+	std::vector<ChannelPair> m_pairs;
+	int m_layoutChannels = 0;
 
-	LinkwitzRileySecondOrder m_lowMidFilter[2] = {};
-	LinkwitzRileySecondOrder m_midHighFilter[2] = {};
-	FirstOrderAllPass m_allPassFilter[2] = {};
+	MeterBridge m_meterBridge;
+	AnalyzerFifo m_analyzerFifo;
 
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (MultibandMSAudioProcessor)
 };
@@ -0,0 +1,55 @@
+/*
+  ==============================================================================
+
+    Factory presets and the A/B snapshots morphed on the audio thread.
+
+  ==============================================================================
+*/
+
+#include "PresetBank.h"
+#include <cmath>
+
+//==============================================================================
+// The first preset holds the parameter defaults of createParameterLayout
+const PresetBank::Preset PresetBank::presets[N_PRESETS] =
+{
+	{ "Default",       { 1.0f,  440.0f, 1.0f, 3520.5f, 1.0f,  0.0f } },
+	{ "Mono Bass",     { 0.0f,  160.0f, 1.0f, 3520.5f, 1.0f,  0.0f } },
+	{ "Wide Air",      { 1.0f,  440.0f, 1.0f, 5000.0f, 1.6f, -1.0f } },
+	{ "Focused Mids",  { 0.8f,  300.0f, 0.6f, 3000.0f, 1.2f,  0.0f } },
+	{ "Master Widen",  { 0.2f,  200.0f, 1.2f, 4000.0f, 1.4f, -1.5f } },
+	{ "Narrow",        { 0.5f,  440.0f, 0.5f, 3520.5f, 0.5f,  0.0f } }
+};
+
+PresetBank::PresetBank()
+{
+	for (auto& slot : m_slots)
+		for (int index = 0; index < N_VALUES; ++index)
+			slot[index].store(presets[0].values[index]);
+}
+
+void PresetBank::store(int slot, const float* values)
+{
+	for (int index = 0; index < N_VALUES; ++index)
+		if (std::isfinite(values[index]))
+			m_slots[slot][index].store(values[index]);
+}
+
+void PresetBank::get(int slot, float* values) const
+{
+	for (int index = 0; index < N_VALUES; ++index)
+		values[index] = m_slots[slot][index].load();
+}
+
+void PresetBank::morph(float amount, float* values) const
+{
+	for (int index = 0; index < N_VALUES; ++index)
+	{
+		const float a = m_slots[0][index].load();
+		const float b = m_slots[1][index].load();
+
+		// The ratio of a frequency of 0 or below would turn the power into NaN or infinity
+		const bool geometric = isFrequency(index) && a > 0.0f && b > 0.0f;
+		values[index] = geometric ? a * std::pow(b / a, amount) : a + amount * (b - a);
+	}
+}
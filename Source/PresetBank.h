@@ -0,0 +1,48 @@
+/*
+  ==============================================================================
+
+    Factory presets and the A/B snapshots morphed on the audio thread.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <atomic>
+
+//==============================================================================
+// Presets and snapshots cover the continuous parameters, the first N_VALUES of
+// MultibandMSAudioProcessor::paramsNames. Slope, phase and oversampling stay as they are,
+// so switching never resets filter states and goes through the parameter smoothing.
+class PresetBank
+{
+public:
+	static const int N_VALUES = 6; // Low, FreqLM, Mid, FreqMH, High, Volume
+	static const int N_PRESETS = 6;
+	static const int N_SLOTS = 2;  // A and B
+
+	struct Preset
+	{
+		const char* name;
+		float values[N_VALUES];
+	};
+
+	static const Preset presets[N_PRESETS];
+
+	// Both snapshots start at the first preset, the parameter defaults
+	PresetBank();
+
+	// Message thread. Non-finite values leave the stored ones as they are; ranges are up to the caller.
+	void store(int slot, const float* values);
+	void get(int slot, float* values) const;
+
+	// Audio thread, morph 0 gives A and 1 gives B. Widths and volume in dB move linearly,
+	// frequencies geometrically, so a morph sweeps crossovers evenly on the log scale, or linearly
+	// should either snapshot hold one that is not positive.
+	void morph(float amount, float* values) const;
+
+private:
+	static bool isFrequency(int index) { return index == 1 || index == 3; }
+
+	std::atomic<float> m_slots[N_SLOTS][N_VALUES];
+};
@@ -0,0 +1,131 @@
+/*
+  ==============================================================================
+
+    Minimal 4-lane double vector, the double precision counterpart of Float4.
+    Maps to pairs of SSE2 or AArch64 NEON registers, one AVX register and plain
+    doubles elsewhere.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include "SimdFloat4.h"
+
+#if MULTIBANDMS_SIMD_NEON && defined(__aarch64__)
+ #define MULTIBANDMS_SIMD_NEON_DOUBLE 1
+#endif
+
+//==============================================================================
+template <SimdKernel Kernel>
+struct Double4;
+
+#if MULTIBANDMS_SIMD_SSE2
+template <>
+struct Double4<SimdKernel::Sse2>
+{
+	__m128d lo;
+	__m128d hi;
+
+	static inline Double4 set(double a, double b, double c, double d) { return { _mm_setr_pd(a, b), _mm_setr_pd(c, d) }; }
+	static inline Double4 broadcast(double a)                         { return { _mm_set1_pd(a), _mm_set1_pd(a) }; }
+	static inline Double4 load(const double* p)                       { return { _mm_loadu_pd(p), _mm_loadu_pd(p + 2) }; }
+	inline void store(double* p) const                                { _mm_storeu_pd(p, lo); _mm_storeu_pd(p + 2, hi); }
+
+	// [a, b, c, d] -> [c, d, c, d]
+	inline Double4 upperHalves() const                                { return { hi, hi }; }
+
+	friend inline Double4 operator+ (Double4 a, Double4 b)            { return { _mm_add_pd(a.lo, b.lo), _mm_add_pd(a.hi, b.hi) }; }
+	friend inline Double4 operator- (Double4 a, Double4 b)            { return { _mm_sub_pd(a.lo, b.lo), _mm_sub_pd(a.hi, b.hi) }; }
+	friend inline Double4 operator* (Double4 a, Double4 b)            { return { _mm_mul_pd(a.lo, b.lo), _mm_mul_pd(a.hi, b.hi) }; }
+};
+#endif
+
+#if MULTIBANDMS_SIMD_AVX2
+// All four lanes in one register, half the instructions of the SSE2 pairs. The arithmetic is AVX,
+// the lane shuffle the AVX2 vpermpd, and the compiler may use AVX2 anywhere in the file, so the
+// kernel needs an AVX2 CPU.
+template <>
+struct Double4<SimdKernel::Avx2>
+{
+	__m256d v;
+
+	static inline Double4 set(double a, double b, double c, double d) { return { _mm256_setr_pd(a, b, c, d) }; }
+	static inline Double4 broadcast(double a)                         { return { _mm256_set1_pd(a) }; }
+	static inline Double4 load(const double* p)                       { return { _mm256_loadu_pd(p) }; }
+	inline void store(double* p) const                                { _mm256_storeu_pd(p, v); }
+
+	// [a, b, c, d] -> [c, d, c, d]
+	inline Double4 upperHalves() const                                { return { _mm256_permute4x64_pd(v, 0xee) }; }
+
+	friend inline Double4 operator+ (Double4 a, Double4 b)            { return { _mm256_add_pd(a.v, b.v) }; }
+	friend inline Double4 operator- (Double4 a, Double4 b)            { return { _mm256_sub_pd(a.v, b.v) }; }
+	friend inline Double4 operator* (Double4 a, Double4 b)            { return { _mm256_mul_pd(a.v, b.v) }; }
+};
+#endif
+
+#if MULTIBANDMS_SIMD_NEON_DOUBLE
+template <>
+struct Double4<SimdKernel::Neon>
+{
+	float64x2_t lo;
+	float64x2_t hi;
+
+	static inline Double4 set(double a, double b, double c, double d) { const double f[4] = { a, b, c, d }; return { vld1q_f64(f), vld1q_f64(f + 2) }; }
+	static inline Double4 broadcast(double a)                         { return { vdupq_n_f64(a), vdupq_n_f64(a) }; }
+	static inline Double4 load(const double* p)                       { return { vld1q_f64(p), vld1q_f64(p + 2) }; }
+	inline void store(double* p) const                                { vst1q_f64(p, lo); vst1q_f64(p + 2, hi); }
+
+	// [a, b, c, d] -> [c, d, c, d]
+	inline Double4 upperHalves() const                                { return { hi, hi }; }
+
+	friend inline Double4 operator+ (Double4 a, Double4 b)            { return { vaddq_f64(a.lo, b.lo), vaddq_f64(a.hi, b.hi) }; }
+	friend inline Double4 operator- (Double4 a, Double4 b)            { return { vsubq_f64(a.lo, b.lo), vsubq_f64(a.hi, b.hi) }; }
+	friend inline Double4 operator* (Double4 a, Double4 b)            { return { vmulq_f64(a.lo, b.lo), vmulq_f64(a.hi, b.hi) }; }
+};
+#endif
+
+template <>
+struct Double4<SimdKernel::Scalar>
+{
+	double v[4];
+
+	static inline Double4 set(double a, double b, double c, double d) { return { { a, b, c, d } }; }
+	static inline Double4 broadcast(double a)                         { return { { a, a, a, a } }; }
+	static inline Double4 load(const double* p)                       { return { { p[0], p[1], p[2], p[3] } }; }
+	inline void store(double* p) const                                { p[0] = v[0]; p[1] = v[1]; p[2] = v[2]; p[3] = v[3]; }
+
+	// [a, b, c, d] -> [c, d, c, d]
+	inline Double4 upperHalves() const                                { return { { v[2], v[3], v[2], v[3] } }; }
+
+	friend inline Double4 operator+ (Double4 a, Double4 b)            { return { { a.v[0] + b.v[0], a.v[1] + b.v[1], a.v[2] + b.v[2], a.v[3] + b.v[3] } }; }
+	friend inline Double4 operator- (Double4 a, Double4 b)            { return { { a.v[0] - b.v[0], a.v[1] - b.v[1], a.v[2] - b.v[2], a.v[3] - b.v[3] } }; }
+	friend inline Double4 operator* (Double4 a, Double4 b)            { return { { a.v[0] * b.v[0], a.v[1] * b.v[1], a.v[2] * b.v[2], a.v[3] * b.v[3] } }; }
+};
+
+//==============================================================================
+// 4-lane vector of SampleType for one kernel, so the stereo kernels can be written once for
+// both precisions and every instruction set
+template <typename SampleType, SimdKernel Kernel = NATIVE_KERNEL>
+struct Vector4;
+
+template <SimdKernel Kernel>
+struct Vector4<float, Kernel>
+{
+	using Type = Float4<Kernel>;
+};
+
+template <SimdKernel Kernel>
+struct Vector4<double, Kernel>
+{
+	using Type = Double4<Kernel>;
+};
+
+#if MULTIBANDMS_SIMD_NEON && !MULTIBANDMS_SIMD_NEON_DOUBLE
+// 32 bit ARM has no double precision NEON
+template <>
+struct Vector4<double, SimdKernel::Neon>
+{
+	using Type = Double4<SimdKernel::Scalar>;
+};
+#endif
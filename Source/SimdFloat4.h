@@ -0,0 +1,110 @@
+/*
+  ==============================================================================
+
+    Minimal 4-lane float vector used by the stereo filter kernels.
+    Maps to SSE2 on x86, NEON on ARM and plain floats, one type per SimdKernel.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+ #include <emmintrin.h>
+ #define MULTIBANDMS_SIMD_SSE2 1
+
+ // Only in files built with AVX2 code generation: -mavx2, or /arch:AVX2 on MSVC, which define __AVX2__
+ #if defined(__AVX2__)
+  #include <immintrin.h>
+  #define MULTIBANDMS_SIMD_AVX2 1
+ #endif
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+ #include <arm_neon.h>
+ #define MULTIBANDMS_SIMD_NEON 1
+#endif
+
+//==============================================================================
+// Instruction sets the stereo kernels can be built for. Which ones a binary contains depends
+// on its target, which one runs is picked at runtime, see CrossoverKernels.h.
+enum class SimdKernel
+{
+	Auto, // the fastest one this CPU supports
+	Scalar,
+	Sse2,
+	Avx2,
+	Neon
+};
+
+// Kernel the vector types default to, the baseline of the target
+#if MULTIBANDMS_SIMD_SSE2
+static constexpr SimdKernel NATIVE_KERNEL = SimdKernel::Sse2;
+#elif MULTIBANDMS_SIMD_NEON
+static constexpr SimdKernel NATIVE_KERNEL = SimdKernel::Neon;
+#else
+static constexpr SimdKernel NATIVE_KERNEL = SimdKernel::Scalar;
+#endif
+
+//==============================================================================
+template <SimdKernel Kernel>
+struct Float4;
+
+#if MULTIBANDMS_SIMD_SSE2
+// Four floats fill an SSE register, so SSE2 and AVX2 share this code; AVX2 builds only add the
+// VEX encoding. They are still separate types, so code built for AVX2 never stands in for the
+// SSE2 build when the linker merges template instances.
+template <SimdKernel Kernel>
+struct Float4
+{
+	__m128 v;
+
+	static inline Float4 set(float a, float b, float c, float d) { return { _mm_setr_ps(a, b, c, d) }; }
+	static inline Float4 broadcast(float a)                      { return { _mm_set1_ps(a) }; }
+	static inline Float4 load(const float* p)                    { return { _mm_loadu_ps(p) }; }
+	inline void store(float* p) const                            { _mm_storeu_ps(p, v); }
+
+	// [a, b, c, d] -> [c, d, c, d]
+	inline Float4 upperHalves() const                            { return { _mm_movehl_ps(v, v) }; }
+
+	friend inline Float4 operator+ (Float4 a, Float4 b)          { return { _mm_add_ps(a.v, b.v) }; }
+	friend inline Float4 operator- (Float4 a, Float4 b)          { return { _mm_sub_ps(a.v, b.v) }; }
+	friend inline Float4 operator* (Float4 a, Float4 b)          { return { _mm_mul_ps(a.v, b.v) }; }
+};
+#endif
+
+#if MULTIBANDMS_SIMD_NEON
+template <>
+struct Float4<SimdKernel::Neon>
+{
+	float32x4_t v;
+
+	static inline Float4 set(float a, float b, float c, float d) { const float f[4] = { a, b, c, d }; return { vld1q_f32(f) }; }
+	static inline Float4 broadcast(float a)                      { return { vdupq_n_f32(a) }; }
+	static inline Float4 load(const float* p)                    { return { vld1q_f32(p) }; }
+	inline void store(float* p) const                            { vst1q_f32(p, v); }
+
+	// [a, b, c, d] -> [c, d, c, d]
+	inline Float4 upperHalves() const                            { return { vcombine_f32(vget_high_f32(v), vget_high_f32(v)) }; }
+
+	friend inline Float4 operator+ (Float4 a, Float4 b)          { return { vaddq_f32(a.v, b.v) }; }
+	friend inline Float4 operator- (Float4 a, Float4 b)          { return { vsubq_f32(a.v, b.v) }; }
+	friend inline Float4 operator* (Float4 a, Float4 b)          { return { vmulq_f32(a.v, b.v) }; }
+};
+#endif
+
+template <>
+struct Float4<SimdKernel::Scalar>
+{
+	float v[4];
+
+	static inline Float4 set(float a, float b, float c, float d) { return { { a, b, c, d } }; }
+	static inline Float4 broadcast(float a)                      { return { { a, a, a, a } }; }
+	static inline Float4 load(const float* p)                    { return { { p[0], p[1], p[2], p[3] } }; }
+	inline void store(float* p) const                            { p[0] = v[0]; p[1] = v[1]; p[2] = v[2]; p[3] = v[3]; }
+
+	// [a, b, c, d] -> [c, d, c, d]
+	inline Float4 upperHalves() const                            { return { { v[2], v[3], v[2], v[3] } }; }
+
+	friend inline Float4 operator+ (Float4 a, Float4 b)          { return { { a.v[0] + b.v[0], a.v[1] + b.v[1], a.v[2] + b.v[2], a.v[3] + b.v[3] } }; }
+	friend inline Float4 operator- (Float4 a, Float4 b)          { return { { a.v[0] - b.v[0], a.v[1] - b.v[1], a.v[2] - b.v[2], a.v[3] - b.v[3] } }; }
+	friend inline Float4 operator* (Float4 a, Float4 b)          { return { { a.v[0] * b.v[0], a.v[1] * b.v[1], a.v[2] * b.v[2], a.v[3] * b.v[3] } }; }
+};
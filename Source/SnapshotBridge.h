@@ -0,0 +1,65 @@
+/*
+  ==============================================================================
+
+    Wait-free single producer, single consumer hand over of the latest snapshot.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <atomic>
+
+//==============================================================================
+// Triple buffer. The producer fills its own slot and swaps it with the shared one; the
+// consumer swaps the shared slot with its own when it holds a newer snapshot. Neither
+// side locks, allocates or waits, and snapshots the consumer misses are simply
+// overwritten. Each side owns its slot until its next publish or acquire, so snapshots
+// may be filled and read in place.
+template <typename Snapshot>
+class SnapshotBridge
+{
+public:
+	// Producer
+	Snapshot& getWriteSlot() { return m_slots[m_write]; }
+
+	void publish()
+	{
+		m_write = m_shared.exchange(m_write | FRESH, std::memory_order_acq_rel) & ~FRESH;
+	}
+
+	void publish(const Snapshot& snapshot)
+	{
+		m_slots[m_write] = snapshot;
+		publish();
+	}
+
+	// Consumer, false if nothing was published since the last acquire
+	bool acquire()
+	{
+		if ((m_shared.load(std::memory_order_relaxed) & FRESH) == 0)
+			return false;
+
+		m_read = m_shared.exchange(m_read, std::memory_order_acq_rel) & ~FRESH;
+		return true;
+	}
+
+	const Snapshot& getReadSlot() const { return m_slots[m_read]; }
+
+	bool read(Snapshot& snapshot)
+	{
+		if (!acquire())
+			return false;
+
+		snapshot = m_slots[m_read];
+		return true;
+	}
+
+private:
+	static const int FRESH = 4; // set on m_shared when it holds an unread snapshot
+
+	Snapshot m_slots[3];
+	std::atomic<int> m_shared{ 1 };
+	int m_write = 0;
+	int m_read = 2;
+};